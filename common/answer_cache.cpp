@@ -0,0 +1,120 @@
+#include "answer_cache.hpp"
+
+// Generated by the build (see common/CMakeLists.txt).
+#include "build_id.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string_view>
+
+namespace aoc2024 {
+namespace {
+
+// Bumped whenever the layout of the block changes.
+constexpr std::uint32_t kFormatVersion = 2;
+
+// A newer build may fix a wrong answer which an older one cached, so the magic
+// number is a 32-bit FNV-1a hash of the build ID (itself a hash of the sources)
+// and the format version. Flashing a build of different code discards
+// everything which was cached before.
+constexpr std::uint32_t kMagic = [] {
+  std::uint32_t hash = 0x811c'9dc5 ^ kFormatVersion;
+  for (char c : std::string_view(AOC2024_BUILD_ID)) {
+    hash = (hash ^ std::uint8_t(c)) * 0x100'0193;
+  }
+  return hash;
+}();
+
+// The day, hash and size which precede each answer.
+constexpr std::size_t kEntryHeaderSize = 1 + 8 + 2;
+
+std::uint64_t Load(const char* p, int num_bytes) {
+  std::uint64_t x = 0;
+  for (int i = num_bytes - 1; i >= 0; i--) x = x << 8 | std::uint8_t(p[i]);
+  return x;
+}
+
+void Store(char* p, int num_bytes, std::uint64_t x) {
+  for (int i = 0; i < num_bytes; i++) p[i] = char(x >> (8 * i));
+}
+
+}  // namespace
+
+AnswerCache::AnswerCache() {
+  LoadAnswerCache(data_);
+  size_ = 4;
+  if (Load(data_, 4) != kMagic) {
+    Store(data_, 4, kMagic);
+    data_[size_] = 0;
+    return;
+  }
+  while (std::optional<Entry> entry = EntryAt(size_)) size_ = entry->end;
+  // Anything after the last valid entry (such as a partly written one) is
+  // dropped.
+  if (size_ < kCapacity) data_[size_] = 0;
+}
+
+std::optional<AnswerCache::Entry> AnswerCache::EntryAt(
+    std::size_t offset) const {
+  if (kCapacity - offset < kEntryHeaderSize) return std::nullopt;
+  const char* p = data_ + offset;
+  const int day = std::uint8_t(p[0]);
+  if (!(1 <= day && day <= 25)) return std::nullopt;
+  const std::size_t size = Load(p + 9, 2);
+  if (kCapacity - offset - kEntryHeaderSize < size) return std::nullopt;
+  return Entry{
+      .day = day,
+      .hash = Load(p + 1, 8),
+      .answer = std::string_view(p + kEntryHeaderSize, size),
+      .begin = offset,
+      .end = offset + kEntryHeaderSize + size,
+  };
+}
+
+std::optional<std::string_view> AnswerCache::Find(int day,
+                                                  std::uint64_t hash) const {
+  for (std::size_t offset = 4; offset < size_;) {
+    const Entry entry = *EntryAt(offset);
+    if (entry.day == day && entry.hash == hash) return entry.answer;
+    offset = entry.end;
+  }
+  return std::nullopt;
+}
+
+void AnswerCache::Erase(const Entry& entry) {
+  std::memmove(data_ + entry.begin, data_ + entry.end, size_ - entry.end);
+  size_ -= entry.end - entry.begin;
+}
+
+void AnswerCache::Insert(int day, std::uint64_t hash, std::string_view answer) {
+  const std::size_t size = kEntryHeaderSize + answer.size();
+  if (size > kCapacity - 4) throw std::runtime_error("answer too big to cache");
+  for (std::size_t offset = 4; offset < size_;) {
+    const Entry entry = *EntryAt(offset);
+    if (entry.day == day && entry.hash == hash) {
+      // Another connection may have solved the same input in the meantime.
+      if (entry.answer == answer) return;
+      Erase(entry);
+      break;
+    }
+    offset = entry.end;
+  }
+  while (kCapacity - size_ < size) Erase(*EntryAt(4));
+  char* p = data_ + size_;
+  p[0] = char(day);
+  Store(p + 1, 8, hash);
+  Store(p + 9, 2, answer.size());
+  std::ranges::copy(answer, p + kEntryHeaderSize);
+  size_ += size;
+  if (size_ < kCapacity) data_[size_] = 0;
+  dirty_ = true;
+}
+
+void AnswerCache::Persist() {
+  if (!dirty_) return;
+  StoreAnswerCache(data_);
+  dirty_ = false;
+}
+
+}  // namespace aoc2024
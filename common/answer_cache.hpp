@@ -0,0 +1,75 @@
+#ifndef AOC2024_ANSWER_CACHE_HPP_
+#define AOC2024_ANSWER_CACHE_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string_view>
+
+namespace aoc2024 {
+
+// Remembers the answer for each (day, input hash) that has been solved, so that
+// submitting the same input again is answered without solving it. The entries
+// are packed into a single block which is persisted by the platform: a flash
+// sector on the Pico, or a file on the host. Once the block is full, the oldest
+// entries are evicted. Neither threadsafe nor reentrant.
+class AnswerCache {
+ public:
+  static constexpr std::size_t kCapacity = 4096;
+
+  // Loads the cache from persistent storage. If there is no valid cache there,
+  // the cache starts out empty.
+  AnswerCache();
+
+  // Not copyable.
+  AnswerCache(const AnswerCache&) = delete;
+  AnswerCache& operator=(const AnswerCache&) = delete;
+
+  // The view is invalidated by `Insert`.
+  std::optional<std::string_view> Find(int day, std::uint64_t hash) const;
+
+  // Adds or replaces an answer. Nothing is written to persistent storage until
+  // `Persist()`.
+  void Insert(int day, std::uint64_t hash, std::string_view answer);
+
+  // Writes the cache to persistent storage, if it has changed since it was
+  // loaded or last persisted. On the Pico this erases a flash sector, which
+  // stalls everything, so the server batches up answers and only persists
+  // them once it is idle. Throws if the cache can't be persisted.
+  void Persist();
+
+ private:
+  // The block starts with a 32-bit magic number which identifies both the
+  // format and the build which wrote it (see answer_cache.cpp), followed by
+  // the entries from oldest to newest. Each entry is an 8-bit day, a 64-bit
+  // hash, a 16-bit size and then the answer, with multi-byte fields in
+  // little-endian order. A zero day marks the end of the entries.
+
+  struct Entry {
+    int day;
+    std::uint64_t hash;
+    std::string_view answer;
+    // The offset of the entry and of the one after it.
+    std::size_t begin, end;
+  };
+
+  // Decodes the entry at `offset`, if there is one.
+  std::optional<Entry> EntryAt(std::size_t offset) const;
+
+  void Erase(const Entry& entry);
+
+  char data_[kCapacity];
+  // The offset just past the newest entry.
+  std::size_t size_;
+  // Whether `data_` differs from the persistent copy.
+  bool dirty_ = false;
+};
+
+// Reads and writes the persistent copy of the cache. Implemented per platform.
+void LoadAnswerCache(std::span<char, AnswerCache::kCapacity> data);
+void StoreAnswerCache(std::span<const char, AnswerCache::kCapacity> data);
+
+}  // namespace aoc2024
+
+#endif  // AOC2024_ANSWER_CACHE_HPP_
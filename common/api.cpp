@@ -1,5 +1,6 @@
 #include "api.hpp"
 
+#include <algorithm>
 #include <stdexcept>
 
 namespace aoc2024 {
@@ -24,6 +25,39 @@ char* EmitUint32(char* p, std::uint32_t x) {
   return p;
 }
 
+char* EmitUint64(char* p, std::uint64_t x) {
+  p = EmitUint32(p, x);
+  p = EmitUint32(p, x >> 32);
+  return p;
+}
+
+std::span<const char> ConsumeBytes(std::span<const char>& bytes, int n) {
+  if (bytes.size() < std::size_t(n)) {
+    throw std::runtime_error("Bad response (truncated packet).");
+  }
+  const std::span<const char> result = bytes.subspan(0, n);
+  bytes = bytes.subspan(n);
+  return result;
+}
+
+std::uint8_t ParseUint8(std::span<const char> bytes) {
+  assert(bytes.size() == 1);
+  return bytes[0];
+}
+
+std::uint32_t ParseUint32(std::span<const char> bytes) {
+  assert(bytes.size() == 4);
+  std::uint32_t x = 0;
+  for (int i = 3; i >= 0; i--) x = x << 8 | std::uint8_t(bytes[i]);
+  return x;
+}
+
+std::uint64_t ParseUint64(std::span<const char> bytes) {
+  assert(bytes.size() == 8);
+  return ParseUint32(bytes.subspan(0, 4)) |
+         std::uint64_t(ParseUint32(bytes.subspan(4, 4))) << 32;
+}
+
 }  // namespace
 
 RequestHeader RequestHeader::Decode(
@@ -31,7 +65,9 @@ RequestHeader RequestHeader::Decode(
   if (!(1 <= bytes[0] && bytes[0] <= 25)) {
     throw std::runtime_error("Bad request header (invalid day).");
   }
-  return RequestHeader{.day = std::int8_t(bytes[0])};
+  return RequestHeader{.day = std::int8_t(bytes[0]),
+                       .input_size = ParseUint32(bytes.subspan<1, 4>()),
+                       .input_hash = ParseUint64(bytes.subspan<5, 8>())};
 }
 
 RequestHeader RequestHeader::Decode(std::span<const char> bytes) {
@@ -44,14 +80,97 @@ RequestHeader RequestHeader::Decode(std::span<const char> bytes) {
   return Decode(std::span<const char, RequestHeader::kNumBytes>(bytes));
 }
 
+std::uint32_t RequestHeader::DecodeInputSize(
+    std::span<const char, RequestHeader::kNumBytes> bytes) {
+  return ParseUint32(bytes.subspan<1, 4>());
+}
+
 void RequestHeader::EncodeTo(
     std::span<char, RequestHeader::kNumBytes> bytes) const {
-  bytes[0] = day;
+  char* p = bytes.data();
+  p = EmitUint8(p, day);
+  p = EmitUint32(p, input_size);
+  p = EmitUint64(p, input_hash);
+}
+
+ResponseHeader ResponseHeader::Decode(
+    std::span<const char, ResponseHeader::kNumBytes> bytes) {
+  return ResponseHeader{.size = std::uint16_t(std::uint8_t(bytes[0]) |
+                                              std::uint8_t(bytes[1]) << 8)};
+}
+
+void ResponseHeader::EncodeTo(
+    std::span<char, ResponseHeader::kNumBytes> bytes) const {
+  EmitUint16(bytes.data(), size);
+}
+
+const char* EventName(Event event) {
+  switch (event) {
+    case Event::kRequestParsed: return "request parsed";
+    case Event::kInputParsed: return "input parsed";
+    case Event::kPart1Done: return "part 1 done";
+    case Event::kDone: return "done";
+    case Event::kSpan: return "span";
+    case Event::kMemory: return "memory";
+  }
+  return "unknown event";
+}
+
+std::string FormatMemoryUsage(const MemoryUsage& usage) {
+  std::string result =
+      std::format("memory: stack {} of {} bytes, heap {}", usage.stack_used,
+                  usage.stack_available, usage.heap_used);
+  if (usage.heap_available) {
+    result += std::format(" of {}", usage.heap_available);
+  }
+  result += std::format(
+      " bytes in {} allocations ({} in use, largest free block {})",
+      usage.heap_allocations, usage.heap_in_use, usage.heap_largest_free);
+  return result;
+}
+
+ResponsePacket ResponsePacket::Decode(std::span<const char>& bytes) {
+  const std::uint8_t header = ConsumeBytes(bytes, 1)[0];
+  const auto type = ResponsePacketType(header & 0b1100'0000);
+  const std::uint8_t low_bits = header & 0b0011'1111;
+  switch (type) {
+    case ResponsePacketType::kOutput:
+    case ResponsePacketType::kDebug: {
+      const int size = low_bits << 8 | std::uint8_t(ConsumeBytes(bytes, 1)[0]);
+      const std::span<const char> text = ConsumeBytes(bytes, size);
+      return ResponsePacket{
+          .type = type, .text = std::string_view(text.data(), text.size())};
+    }
+    case ResponsePacketType::kEvent: {
+      const std::uint32_t micros = ParseUint32(ConsumeBytes(bytes, 4));
+      ResponsePacket packet{.type = type,
+                            .event = Event(low_bits),
+                            .time = std::chrono::microseconds(micros)};
+      if (packet.event == Event::kSpan) {
+        packet.duration =
+            std::chrono::microseconds(ParseUint32(ConsumeBytes(bytes, 4)));
+        packet.depth = ParseUint8(ConsumeBytes(bytes, 1));
+        const int size = ParseUint8(ConsumeBytes(bytes, 1));
+        const std::span<const char> label = ConsumeBytes(bytes, size);
+        packet.label = std::string_view(label.data(), label.size());
+      } else if (packet.event == Event::kMemory) {
+        packet.memory.stack_used = ParseUint32(ConsumeBytes(bytes, 4));
+        packet.memory.stack_available = ParseUint32(ConsumeBytes(bytes, 4));
+        packet.memory.heap_used = ParseUint32(ConsumeBytes(bytes, 4));
+        packet.memory.heap_available = ParseUint32(ConsumeBytes(bytes, 4));
+        packet.memory.heap_in_use = ParseUint32(ConsumeBytes(bytes, 4));
+        packet.memory.heap_largest_free = ParseUint32(ConsumeBytes(bytes, 4));
+        packet.memory.heap_allocations = ParseUint32(ConsumeBytes(bytes, 4));
+      }
+      return packet;
+    }
+  }
+  throw std::runtime_error("Bad response (unknown packet type).");
 }
 
 void Response::RecordEvent(Event event) {
-  const Time now = Clock::now();
-  const std::uint32_t micros = (now - start_) / 1us;
+  assert(event != Event::kSpan && event != Event::kMemory);
+  const std::uint32_t micros = Now();
   // Type and event byte followed by a 32-bit duration in micros.
   char* p = unused_.data();
   Advance(5);
@@ -60,10 +179,55 @@ void Response::RecordEvent(Event event) {
   p = EmitUint32(p, micros);
 }
 
+void Response::RecordMemory(const MemoryUsage& usage) {
+  const std::uint32_t micros = Now();
+  // Type and event byte, the time, and then the seven fields of the usage.
+  char* p = unused_.data();
+  Advance(33);
+  p = EmitUint8(p, std::uint8_t(ResponsePacketType::kEvent) |
+                       std::uint8_t(Event::kMemory));
+  p = EmitUint32(p, micros);
+  p = EmitUint32(p, usage.stack_used);
+  p = EmitUint32(p, usage.stack_available);
+  p = EmitUint32(p, usage.heap_used);
+  p = EmitUint32(p, usage.heap_available);
+  p = EmitUint32(p, usage.heap_in_use);
+  p = EmitUint32(p, usage.heap_largest_free);
+  p = EmitUint32(p, usage.heap_allocations);
+}
+
+int Response::FlushSpans() {
+  assert(depth_ == 0);
+  const int num_kept = std::min(num_spans_, kMaxSpans);
+  int num_dropped = num_spans_ - num_kept;
+  for (int i = num_spans_ - num_kept; i < num_spans_; i++) {
+    const Span& span = spans_[i % kMaxSpans];
+    const std::string_view label = span.label.substr(0, 255);
+    const int size = 11 + label.size();
+    if (unused_.size() < std::size_t(size)) {
+      num_dropped++;
+      continue;
+    }
+    char* p = unused_.data();
+    Advance(size);
+    p = EmitUint8(p, std::uint8_t(ResponsePacketType::kEvent) |
+                         std::uint8_t(Event::kSpan));
+    p = EmitUint32(p, span.start);
+    p = EmitUint32(p, span.end - span.start);
+    p = EmitUint8(p, span.depth);
+    p = EmitUint8(p, label.size());
+    std::ranges::copy(label, p);
+  }
+  num_spans_ = 0;
+  return num_dropped;
+}
+
 std::span<char> Response::bytes() const {
   return buffer_.subspan(0, buffer_.size() - unused_.size());
 }
 
+std::uint32_t Response::Now() const { return (Clock::now() - start_) / 1us; }
+
 void Response::Advance(int x) {
   if (unused_.size() < std::size_t(x)) {
     throw std::runtime_error("response too big");
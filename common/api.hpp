@@ -1,33 +1,72 @@
 #ifndef AOC2024_API_HPP_
 #define AOC2024_API_HPP_
 
+#include "memory.hpp"
+
 #include <cassert>
 #include <chrono>
 #include <cstdint>
 #include <format>
+#include <memory_resource>
 #include <span>
+#include <string>
+#include <string_view>
 
 namespace aoc2024 {
 
+// A connection carries any number of requests, each of which is a header
+// followed by `input_size` bytes of puzzle input. The server answers them in
+// order with a `ResponseHeader` and the response itself, so a client can send
+// all of its requests up front and then close its side of the connection.
 struct RequestHeader {
-  static constexpr int kNumBytes = 1;
+  static constexpr int kNumBytes = 13;
 
   static RequestHeader Decode(std::span<const char, kNumBytes> bytes);
   static RequestHeader Decode(std::span<const char> bytes);
+  // Just the input size, which can be decoded even when the rest of the
+  // header is bad, so that the server can skip the input and carry on.
+  static std::uint32_t DecodeInputSize(
+      std::span<const char, kNumBytes> bytes);
   void EncodeTo(std::span<char, kNumBytes> bytes) const;
 
   std::int8_t day;
+  // 32 bits on the wire, little-endian.
+  std::uint32_t input_size;
+  // The `InputHash` of the input, which the server uses to look up a cached
+  // answer before reading the input (and checks once it has). 64 bits on the
+  // wire, little-endian.
+  std::uint64_t input_hash;
+};
+
+// Precedes each response on a connection.
+struct ResponseHeader {
+  static constexpr int kNumBytes = 2;
+
+  static ResponseHeader Decode(std::span<const char, kNumBytes> bytes);
+  void EncodeTo(std::span<char, kNumBytes> bytes) const;
+
+  // The number of bytes of packets in the response. 16 bits on the wire,
+  // little-endian.
+  std::uint16_t size;
 };
 
+// The size of the buffer which the server builds each response in, including
+// its `ResponseHeader`. Anything which runs solutions outside the server should
+// give them the same room.
+inline constexpr int kResponseBufferSize = 1024;
+
 // Only uses the top two bits of the byte. Other bits are repurposed.
 enum class ResponsePacketType : std::uint8_t {
   // Channels used for textual output to stdout/stderr respectively. Payload is
   // a 16-bit length followed by the corresponding number of payload bytes.
   kOutput = 0 << 6,
   kDebug = 1 << 6,
-  // A timing sample for a given event label. Payload is a 32-bit time in
-  // microseconds relative to the start of the request, then an 8-bit label
-  // length, then the corresponding number of bytes for the label.
+  // A timing sample for the `Event` in the low bits. Payload is a 32-bit time
+  // in microseconds relative to the start of the request. For `kSpan`, this is
+  // the start of the span and it is followed by a 32-bit duration in
+  // microseconds, an 8-bit nesting depth, an 8-bit label length, and then the
+  // corresponding number of bytes for the label. For `kMemory`, it is followed
+  // by the fields of a `MemoryUsage` in declaration order, each 32 bits.
   kEvent = 2 << 6,
 };
 
@@ -36,12 +75,49 @@ enum class Event : std::uint8_t {
   kInputParsed,    // Input parsed (if done separately from solving).
   kPart1Done,      // Part 1 solved (if done separately from part 2).
   kDone,           // Both parts solved.
+  kSpan,           // A labelled span recorded by `TraceSpan`.
+  kMemory,         // Peak memory usage of the solution.
+};
+
+const char* EventName(Event event);
+
+// Describes a kMemory event, e.g. "memory: stack 1200 of 3800 bytes, ...".
+std::string FormatMemoryUsage(const MemoryUsage& usage);
+
+// A single packet decoded from the bytes of a `Response`.
+struct ResponsePacket {
+  // Decodes the packet at the start of `bytes` and advances `bytes` past it.
+  // Throws if the packet is malformed or truncated.
+  static ResponsePacket Decode(std::span<const char>& bytes);
+
+  ResponsePacketType type;
+  // The payload of a kOutput or kDebug packet.
+  std::string_view text = {};
+  // The event and time (relative to the start of the request) of a kEvent
+  // packet.
+  Event event = {};
+  std::chrono::microseconds time = {};
+  // The label, duration and nesting depth of a kSpan event.
+  std::string_view label = {};
+  std::chrono::microseconds duration = {};
+  int depth = 0;
+  // The payload of a kMemory event.
+  MemoryUsage memory = {};
 };
 
 class Response {
  public:
-  explicit Response(std::span<char> buffer)
-      : buffer_(buffer), unused_(buffer) {}
+  // `memory` is the scratch memory for the solution (see `memory()`).
+  explicit Response(
+      std::span<char> buffer,
+      std::pmr::memory_resource& memory = *std::pmr::get_default_resource())
+      : buffer_(buffer), unused_(buffer), memory_(memory) {}
+
+  // Memory which the solution can use for `std::pmr` containers. On the server
+  // this is a `RequestArena`, which frees everything at once when the request
+  // is finished, so deallocation is free but memory is never reused within a
+  // request: allocate up front rather than in a loop.
+  std::pmr::memory_resource& memory() const { return memory_; }
 
   template <typename... Args>
   void Print(std::format_string<Args...> format, Args&&... args);
@@ -51,12 +127,33 @@ class Response {
 
   void RecordEvent(Event event);
 
+  // Records a kMemory event with the given usage.
+  void RecordMemory(const MemoryUsage& usage);
+
+  // Appends the spans recorded by `TraceSpan` as kEvent packets, oldest first.
+  // Only the most recent `kMaxSpans` spans are kept, and spans are dropped if
+  // they don't fit in the buffer. Returns the number of dropped spans.
+  int FlushSpans();
+
   std::span<char> bytes() const;
 
  private:
+  friend class TraceSpan;
+
   using Clock = std::chrono::steady_clock;
   using Time = Clock::time_point;
 
+  struct Span {
+    std::string_view label;
+    std::uint32_t start, end;
+    std::uint8_t depth;
+  };
+
+  static constexpr int kMaxSpans = 32;
+
+  // Microseconds since the start of the request.
+  std::uint32_t Now() const;
+
   void Advance(int x);
 
   template <typename... Args>
@@ -68,11 +165,55 @@ class Response {
   // not yet been written to.
   const std::span<char> buffer_;
   std::span<char> unused_;
+  std::pmr::memory_resource& memory_;
+  // A ring buffer of the most recently finished spans. `num_spans_` counts
+  // every span, so the next one is written at `num_spans_ % kMaxSpans`.
+  Span spans_[kMaxSpans];
+  int num_spans_ = 0;
+  // The number of `TraceSpan` objects which are currently alive.
+  int depth_ = 0;
+};
+
+// Records the time between construction and destruction in `response` as a
+// span with the given label. Spans can be nested. The label must outlive the
+// response (typically it is a string literal).
+//
+//     {
+//       TraceSpan span(response, "merge regions");
+//       ...
+//     }
+class TraceSpan {
+ public:
+  TraceSpan(Response& response, std::string_view label)
+      : response_(response),
+        label_(label),
+        start_(response.Now()),
+        depth_(response.depth_++) {}
+
+  ~TraceSpan() {
+    response_.depth_--;
+    response_.spans_[response_.num_spans_++ % Response::kMaxSpans] = {
+        .label = label_,
+        .start = start_,
+        .end = response_.Now(),
+        .depth = std::uint8_t(depth_),
+    };
+  }
+
+  // Not copyable.
+  TraceSpan(const TraceSpan&) = delete;
+  TraceSpan& operator=(const TraceSpan&) = delete;
+
+ private:
+  Response& response_;
+  std::string_view label_;
+  std::uint32_t start_;
+  int depth_;
 };
 
 template <typename... Args>
 void Response::Print(std::format_string<Args...> format, Args&&... args) {
-  Format<Args...>(ResponsePacketType::kDebug, format,
+  Format<Args...>(ResponsePacketType::kOutput, format,
                   std::forward<Args>(args)...);
 }
 
@@ -0,0 +1,174 @@
+#ifndef AOC2024_BIT_GRID_HPP_
+#define AOC2024_BIT_GRID_HPP_
+
+#include <bit>
+#include <cassert>
+#include <cstdint>
+
+namespace aoc2024 {
+
+// A set of cells in a `kWidth` by `kHeight` grid, stored as one bit per cell.
+// Each row is a few machine words, so whole-grid operations such as moving
+// every cell one step in some direction handle 32 cells per instruction. This
+// makes it cheap to grow a region one layer at a time, as in a breadth-first
+// search where every step has the same cost.
+//
+// Bits for cells outside the grid are always clear.
+template <int kWidth, int kHeight>
+class BitGrid {
+ public:
+  using Word = std::uint32_t;
+  static constexpr int kWordBits = 32;
+  static constexpr int kWordsPerRow = (kWidth + kWordBits - 1) / kWordBits;
+
+  // The set of every cell in the grid.
+  static constexpr BitGrid Full() {
+    BitGrid result;
+    for (Row& row : result.rows_) {
+      for (Word& word : row.words) word = ~Word(0);
+    }
+    result.ClearOutside();
+    return result;
+  }
+
+  bool operator[](int x, int y) const {
+    assert(InBounds(x, y));
+    return rows_[y].words[x / kWordBits] >> (x % kWordBits) & 1;
+  }
+
+  void Set(int x, int y) {
+    assert(InBounds(x, y));
+    rows_[y].words[x / kWordBits] |= Word(1) << (x % kWordBits);
+  }
+
+  void Reset(int x, int y) {
+    assert(InBounds(x, y));
+    rows_[y].words[x / kWordBits] &= ~(Word(1) << (x % kWordBits));
+  }
+
+  // The number of cells in the set.
+  int Count() const {
+    int total = 0;
+    for (const Row& row : rows_) {
+      for (Word word : row.words) total += std::popcount(word);
+    }
+    return total;
+  }
+
+  bool Empty() const {
+    for (const Row& row : rows_) {
+      for (Word word : row.words) {
+        if (word) return false;
+      }
+    }
+    return true;
+  }
+
+  friend bool operator==(const BitGrid&, const BitGrid&) = default;
+
+  BitGrid& operator&=(const BitGrid& other) {
+    return Combine(other, [](Word a, Word b) { return a & b; });
+  }
+
+  BitGrid& operator|=(const BitGrid& other) {
+    return Combine(other, [](Word a, Word b) { return a | b; });
+  }
+
+  // Removes the cells of `other` from this set.
+  BitGrid& operator-=(const BitGrid& other) {
+    return Combine(other, [](Word a, Word b) { return a & ~b; });
+  }
+
+  friend BitGrid operator&(BitGrid l, const BitGrid& r) { return l &= r; }
+  friend BitGrid operator|(BitGrid l, const BitGrid& r) { return l |= r; }
+  friend BitGrid operator-(BitGrid l, const BitGrid& r) { return l -= r; }
+
+  // The cells which are not in the set.
+  BitGrid operator~() const { return Full() - *this; }
+
+  // Each of these returns the set of cells one step from a cell of this set
+  // in the given direction. Cells which would leave the grid are dropped.
+  BitGrid Up() const {
+    BitGrid result;
+    for (int y = 0; y < kHeight - 1; y++) result.rows_[y] = rows_[y + 1];
+    return result;
+  }
+
+  BitGrid Down() const {
+    BitGrid result;
+    for (int y = 1; y < kHeight; y++) result.rows_[y] = rows_[y - 1];
+    return result;
+  }
+
+  BitGrid Left() const {
+    BitGrid result;
+    for (int y = 0; y < kHeight; y++) {
+      const Word* in = rows_[y].words;
+      Word* out = result.rows_[y].words;
+      for (int i = 0; i < kWordsPerRow - 1; i++) {
+        out[i] = in[i] >> 1 | in[i + 1] << (kWordBits - 1);
+      }
+      out[kWordsPerRow - 1] = in[kWordsPerRow - 1] >> 1;
+    }
+    return result;
+  }
+
+  BitGrid Right() const {
+    BitGrid result;
+    for (int y = 0; y < kHeight; y++) {
+      const Word* in = rows_[y].words;
+      Word* out = result.rows_[y].words;
+      out[0] = in[0] << 1;
+      for (int i = 1; i < kWordsPerRow; i++) {
+        out[i] = in[i] << 1 | in[i - 1] >> (kWordBits - 1);
+      }
+    }
+    result.ClearOutside();
+    return result;
+  }
+
+  // The cells of this set along with their neighbours in all four directions.
+  BitGrid Dilate() const {
+    return *this | Up() | Down() | Left() | Right();
+  }
+
+  // One layer of a breadth-first search: the cells of `open` which are this
+  // set or a neighbour of it.
+  BitGrid Expand(const BitGrid& open) const { return Dilate() & open; }
+
+ private:
+  struct Row {
+    friend bool operator==(const Row&, const Row&) = default;
+    Word words[kWordsPerRow] = {};
+  };
+
+  static constexpr bool InBounds(int x, int y) {
+    return 0 <= x && x < kWidth && 0 <= y && y < kHeight;
+  }
+
+  template <typename F>
+  BitGrid& Combine(const BitGrid& other, F f) {
+    for (int y = 0; y < kHeight; y++) {
+      for (int i = 0; i < kWordsPerRow; i++) {
+        rows_[y].words[i] = f(rows_[y].words[i], other.rows_[y].words[i]);
+      }
+    }
+    return *this;
+  }
+
+  // Clears the bits past the right hand edge of the grid.
+  constexpr void ClearOutside() {
+    constexpr int kUsed = kWidth - (kWordsPerRow - 1) * kWordBits;
+    if constexpr (kUsed < kWordBits) {
+      for (Row& row : rows_) {
+        row.words[kWordsPerRow - 1] &= (Word(1) << kUsed) - 1;
+      }
+    }
+  }
+
+  Row rows_[kHeight] = {};
+};
+
+}  // namespace aoc2024
+
+#endif  // AOC2024_BIT_GRID_HPP_
@@ -0,0 +1,39 @@
+#include "buffered_reader.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace aoc2024 {
+
+Task<std::optional<std::string_view>> BufferedReader::ReadUntil(
+    char delimiter) {
+  // Number of pending bytes which are known not to contain the delimiter.
+  std::size_t searched = 0;
+  while (true) {
+    const std::string_view pending(buffer_.data() + begin_, end_ - begin_);
+    if (auto i = pending.find(delimiter, searched); i != pending.npos) {
+      begin_ += i + 1;
+      co_return pending.substr(0, i);
+    }
+    searched = pending.size();
+    if (eof_) {
+      if (pending.empty()) co_return std::nullopt;
+      begin_ = end_;
+      co_return pending;
+    }
+    // Move the partial record to the start of the buffer to make space for
+    // more bytes after it.
+    if (begin_ != 0) {
+      std::ranges::copy(pending, buffer_.begin());
+      begin_ = 0;
+      end_ = pending.size();
+    }
+    if (end_ == buffer_.size()) throw std::runtime_error("record too long");
+    const std::span<char> chunk =
+        co_await stream_.ReadChunk(buffer_.subspan(end_));
+    if (chunk.empty()) eof_ = true;
+    end_ += chunk.size();
+  }
+}
+
+}  // namespace aoc2024
@@ -0,0 +1,49 @@
+#ifndef AOC2024_BUFFERED_READER_HPP_
+#define AOC2024_BUFFERED_READER_HPP_
+
+#include "coro.hpp"
+#include "stream.hpp"
+
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <string_view>
+
+namespace aoc2024 {
+
+// Reads delimited records from a stream, using a caller-provided buffer which
+// only needs to be large enough for the longest record. This allows parsing to
+// start as soon as the first record arrives rather than after the whole input
+// has been received. Neither threadsafe nor reentrant.
+class BufferedReader {
+ public:
+  BufferedReader(Stream& stream, std::span<char> buffer)
+      : stream_(stream), buffer_(buffer) {}
+
+  // Not copyable.
+  BufferedReader(const BufferedReader&) = delete;
+  BufferedReader& operator=(const BufferedReader&) = delete;
+
+  // Reads up to and including the next occurrence of `delimiter`. On success,
+  // the awaitable yields the record without the delimiter, which remains valid
+  // until the next read. If the stream ends without a final delimiter, the
+  // trailing bytes are yielded as a record. Once the stream is exhausted, the
+  // awaitable yields `std::nullopt`. If a record does not fit in the buffer, an
+  // exception is thrown.
+  Task<std::optional<std::string_view>> ReadUntil(char delimiter);
+
+  // Equivalent to `ReadUntil('\n')`.
+  Task<std::optional<std::string_view>> ReadLine() { return ReadUntil('\n'); }
+
+ private:
+  Stream& stream_;
+  std::span<char> buffer_;
+  // `buffer_[begin_, end_)` holds bytes which have been read from the stream
+  // but have not yet been returned in a record.
+  std::size_t begin_ = 0, end_ = 0;
+  bool eof_ = false;
+};
+
+}  // namespace aoc2024
+
+#endif  // AOC2024_BUFFERED_READER_HPP_
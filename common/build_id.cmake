@@ -0,0 +1,26 @@
+# Writes a header to OUTPUT which defines AOC2024_BUILD_ID as a hash of every
+# source which the answers depend on, so that changing any of them discards the
+# answer cache. The header is only rewritten when the ID changes, so a build of
+# an unchanged tree doesn't recompile anything. Run by the `build_id_header`
+# target on each build, with SOURCE_DIR set to the root of the repository.
+file(GLOB_RECURSE sources LIST_DIRECTORIES false RELATIVE "${SOURCE_DIR}"
+     "${SOURCE_DIR}/common/*.cpp" "${SOURCE_DIR}/common/*.hpp"
+     "${SOURCE_DIR}/server/*.cpp" "${SOURCE_DIR}/server/*.hpp"
+     "${SOURCE_DIR}/solutions/*.cpp" "${SOURCE_DIR}/solutions/*.hpp")
+list(SORT sources)
+set(hashes "")
+foreach(source IN LISTS sources)
+  file(SHA256 "${SOURCE_DIR}/${source}" hash)
+  string(APPEND hashes "${source} ${hash}\n")
+endforeach()
+string(SHA256 id "${hashes}")
+string(SUBSTRING "${id}" 0 16 id)
+
+set(contents "#define AOC2024_BUILD_ID \"${id}\"\n")
+set(old_contents "")
+if(EXISTS "${OUTPUT}")
+  file(READ "${OUTPUT}" old_contents)
+endif()
+if(NOT old_contents STREQUAL contents)
+  file(WRITE "${OUTPUT}" "${contents}")
+endif()
@@ -1,11 +1,15 @@
 #ifndef AOC2024_CORO_HPP_
 #define AOC2024_CORO_HPP_
 
+#include "frame_arena.hpp"
+
 #include <cassert>
 #include <coroutine>
+#include <cstddef>
 #include <exception>
-#include <functional>
+#include <new>
 #include <optional>
+#include <type_traits>
 #include <utility>
 
 namespace aoc2024 {
@@ -41,7 +45,8 @@ class [[nodiscard]] Task {
   // will be invoked synchronously. Otherwise, `done` will be invoked
   // asynchronously once the task completes. It is the caller's responsibility
   // to ensure that the lifetime of the `Task` object lasts until after `done`
-  // has been invoked.
+  // has been invoked. `done` is stored inline in the promise, so it must be
+  // small and trivially copyable (such as a lambda capturing a few pointers).
   template <std::invocable<T> F>
   requires (!std::is_same_v<T, void>)
   void Start(F&& done);
@@ -69,24 +74,61 @@ struct promise_base {
     assert(state == kNotStarted || state == kDone);
   }
 
-  std::suspend_always initial_suspend() noexcept { return {}; }
+  // Frames are allocated from the current `FrameArena`, if there is one.
+  static void* operator new(std::size_t size) {
+    return FrameArena::AllocateFrame(size);
+  }
+  static void operator delete(void* frame, std::size_t size) noexcept {
+    FrameArena::DeallocateFrame(frame, size);
+  }
 
-  class Invoke {
-   public:
-    explicit Invoke(std::function<void()> done) : done_(std::move(done)) {}
+  std::suspend_always initial_suspend() noexcept { return {}; }
 
+  // Hands control to whoever is waiting for the task: an awaiting coroutine is
+  // resumed directly by symmetric transfer, so long chains of tasks neither
+  // grow the stack nor go through any indirection.
+  struct FinalAwaitable {
     bool await_ready() const noexcept { return false; }
-    void await_suspend(std::coroutine_handle<>) noexcept { done_(); }
-    void await_resume() noexcept {}
 
-   private:
-    std::function<void()> done_;
+    template <typename Promise>
+    std::coroutine_handle<> await_suspend(
+        std::coroutine_handle<Promise> handle) noexcept {
+      promise_base& promise = handle.promise();
+      if (promise.continuation) return promise.continuation;
+      promise.invoke_callback(promise);
+      return std::noop_coroutine();
+    }
+
+    void await_resume() noexcept {}
   };
 
-  Invoke final_suspend() noexcept { return Invoke(std::move(done)); }
+  FinalAwaitable final_suspend() noexcept { return {}; }
+
+  // Stores the callback for `Task::Start`. `invoke` is called with this
+  // promise once the task completes.
+  template <typename F>
+  void SetCallback(F&& f, void (*invoke)(promise_base&)) {
+    using Callback = std::decay_t<F>;
+    static_assert(sizeof(Callback) <= sizeof(callback) &&
+                      alignof(Callback) <= alignof(void*),
+                  "Start callback is too large to store inline");
+    static_assert(std::is_trivially_copyable_v<Callback>,
+                  "Start callback must be trivially copyable");
+    new (callback) Callback(std::forward<F>(f));
+    invoke_callback = invoke;
+  }
+
+  template <typename F>
+  F& GetCallback() {
+    return *std::launder(reinterpret_cast<F*>(callback));
+  }
 
   State state = State::kNotStarted;
-  std::function<void()> done;
+  // Exactly one of these is set once the task has started: `continuation` if
+  // the task is being awaited, or `invoke_callback` if it was started.
+  std::coroutine_handle<> continuation;
+  void (*invoke_callback)(promise_base&) = nullptr;
+  alignas(void*) std::byte callback[2 * sizeof(void*)];
 };
 
 template <typename T>
@@ -169,7 +211,7 @@ bool Task<T>::await_ready() const { return false; }
 template <typename T>
 std::coroutine_handle<> Task<T>::await_suspend(
     std::coroutine_handle<> awaiter) {
-  handle_.promise().done = awaiter;
+  handle_.promise().continuation = awaiter;
   handle_.promise().state = promise_type::kStarted;
   return handle_;
 }
@@ -181,11 +223,13 @@ template <typename T>
 template <std::invocable<T> F>
 requires (!std::is_same_v<T, void>)
 void Task<T>::Start(F&& done) {
+  using Callback = std::decay_t<F>;
   assert(handle_.promise().state == promise_type::kNotStarted);
   handle_.promise().state = promise_type::kStarted;
-  handle_.promise().done = [handle = handle_, done = std::forward<F>(done)] {
-    done(handle.promise().consume());
-  };
+  handle_.promise().SetCallback(std::forward<F>(done), [](promise_base& base) {
+    auto& promise = static_cast<promise_type&>(base);
+    promise.template GetCallback<Callback>()(promise.consume());
+  });
   handle_.resume();
 }
 
@@ -193,12 +237,14 @@ template <typename T>
 template <std::invocable<> F>
 requires std::is_same_v<T, void>
 void Task<T>::Start(F&& done) {
+  using Callback = std::decay_t<F>;
   assert(handle_.promise().state == promise_type::kNotStarted);
   handle_.promise().state = promise_type::kStarted;
-  handle_.promise().done = [handle = handle_, done = std::forward<F>(done)] {
-    handle.promise().consume();
-    done();
-  };
+  handle_.promise().SetCallback(std::forward<F>(done), [](promise_base& base) {
+    auto& promise = static_cast<promise_type&>(base);
+    promise.consume();
+    promise.template GetCallback<Callback>()();
+  });
   handle_.resume();
 }
 
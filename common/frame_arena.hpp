@@ -0,0 +1,123 @@
+#ifndef AOC2024_FRAME_ARENA_HPP_
+#define AOC2024_FRAME_ARENA_HPP_
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <span>
+
+namespace aoc2024 {
+
+// A bump allocator for coroutine frames. While a `FrameArena::Scope` is alive,
+// every `Task` frame which is created is allocated from the arena (or from the
+// heap if it does not fit). Freeing a frame only decrements a count: once all
+// of the frames in the arena are gone, the whole arena is reused in O(1).
+//
+// The server gives each connection its own arena and installs it while it
+// creates the frame for the request's solution, so the large buffers which
+// solutions declare in their coroutine bodies never fragment the heap.
+// Neither threadsafe nor reentrant.
+class FrameArena {
+ public:
+  // `buffer` must be aligned to `__STDCPP_DEFAULT_NEW_ALIGNMENT__`.
+  explicit FrameArena(std::span<std::byte> buffer) : buffer_(buffer) {
+    assert(reinterpret_cast<std::uintptr_t>(buffer.data()) %
+               alignof(Header) == 0);
+  }
+
+  // Not copyable.
+  FrameArena(const FrameArena&) = delete;
+  FrameArena& operator=(const FrameArena&) = delete;
+
+  ~FrameArena() { assert(live_ == 0); }
+
+  // While alive, new frames are allocated from `arena`.
+  class Scope {
+   public:
+    explicit Scope(FrameArena& arena) : previous_(current_) {
+      current_ = &arena;
+    }
+    ~Scope() { current_ = previous_; }
+
+    // Not copyable.
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+   private:
+    FrameArena* previous_;
+  };
+
+  // Allocates a frame from the current arena, if any, or from the heap.
+  static void* AllocateFrame(std::size_t size);
+  static void DeallocateFrame(void* frame, std::size_t size) noexcept;
+
+  // The number of bytes of the arena which are in use, including the bytes
+  // which belong to frames that have been freed since the arena was last
+  // empty.
+  std::size_t used() const { return used_; }
+
+  // The most bytes that have ever been in use.
+  std::size_t high_water() const { return high_water_; }
+
+  // The size of the most recent frame which was created while this arena was
+  // current, whether or not it fitted.
+  std::size_t last_frame_size() const { return last_frame_size_; }
+
+  // The number of frames which fell back to the heap because they did not fit.
+  int overflows() const { return overflows_; }
+
+  // The number of frames which have been allocated from the heap, whether or
+  // not an arena was current.
+  static std::uint32_t heap_frames() { return heap_frames_; }
+
+ private:
+  // Each frame is preceded by a header which records where it came from.
+  struct alignas(__STDCPP_DEFAULT_NEW_ALIGNMENT__) Header {
+    FrameArena* arena;
+  };
+
+  static inline FrameArena* current_ = nullptr;
+  static inline std::uint32_t heap_frames_ = 0;
+
+  std::span<std::byte> buffer_;
+  std::size_t used_ = 0;
+  std::size_t high_water_ = 0;
+  std::size_t last_frame_size_ = 0;
+  int live_ = 0;
+  int overflows_ = 0;
+};
+
+inline void* FrameArena::AllocateFrame(std::size_t size) {
+  constexpr std::size_t kAlign = alignof(Header);
+  const std::size_t total =
+      (sizeof(Header) + size + kAlign - 1) / kAlign * kAlign;
+  FrameArena* arena = current_;
+  if (arena) arena->last_frame_size_ = size;
+  void* memory;
+  if (arena && arena->buffer_.size() - arena->used_ >= total) {
+    memory = arena->buffer_.data() + arena->used_;
+    arena->used_ += total;
+    if (arena->used_ > arena->high_water_) arena->high_water_ = arena->used_;
+    arena->live_++;
+  } else {
+    if (arena) arena->overflows_++;
+    heap_frames_++;
+    arena = nullptr;
+    memory = ::operator new(total);
+  }
+  Header* header = new (memory) Header{.arena = arena};
+  return header + 1;
+}
+
+inline void FrameArena::DeallocateFrame(void* frame, std::size_t) noexcept {
+  Header* header = static_cast<Header*>(frame) - 1;
+  FrameArena* arena = header->arena;
+  if (!arena) return ::operator delete(header);
+  assert(arena->live_ > 0);
+  if (--arena->live_ == 0) arena->used_ = 0;
+}
+
+}  // namespace aoc2024
+
+#endif  // AOC2024_FRAME_ARENA_HPP_
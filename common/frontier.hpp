@@ -0,0 +1,158 @@
+#ifndef AOC2024_FRONTIER_HPP_
+#define AOC2024_FRONTIER_HPP_
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <stdexcept>
+#include <type_traits>
+
+namespace aoc2024 {
+
+// The priority of a value, as given by the projection `kPriority` (typically
+// a pointer to a member, like `&Node::cost`).
+template <typename T, auto kPriority>
+using FrontierPriority =
+    std::remove_cvref_t<std::invoke_result_t<decltype(kPriority), const T&>>;
+
+// A priority queue of at most `kCapacity` values for a best-first search,
+// which pops the value with the lowest priority first. This is a `kArity`-ary
+// heap: a wider heap is shallower, so pushes do less work, while pops compare
+// more children at each level. Throws if the capacity is exceeded.
+template <typename T, auto kPriority, std::size_t kCapacity, int kArity = 2>
+class HeapFrontier {
+ public:
+  static_assert(kArity >= 2);
+  using Priority = FrontierPriority<T, kPriority>;
+
+  bool Empty() const { return size_ == 0; }
+  std::size_t Size() const { return size_; }
+
+  void Push(const T& value) {
+    if (size_ == kCapacity) throw std::runtime_error("frontier is full");
+    const Priority priority = std::invoke(kPriority, value);
+    std::size_t i = size_++;
+    while (i > 0) {
+      const std::size_t parent = (i - 1) / kArity;
+      if (std::invoke(kPriority, data_[parent]) <= priority) break;
+      data_[i] = data_[parent];
+      i = parent;
+    }
+    data_[i] = value;
+  }
+
+  T Pop() {
+    assert(!Empty());
+    const T result = data_[0];
+    const T last = data_[--size_];
+    const Priority priority = std::invoke(kPriority, last);
+    std::size_t i = 0;
+    while (true) {
+      const std::size_t first = kArity * i + 1;
+      if (first >= size_) break;
+      const std::size_t end = std::min(first + kArity, size_);
+      std::size_t best = first;
+      for (std::size_t child = first + 1; child < end; child++) {
+        if (std::invoke(kPriority, data_[child]) <
+            std::invoke(kPriority, data_[best])) {
+          best = child;
+        }
+      }
+      if (priority <= std::invoke(kPriority, data_[best])) break;
+      data_[i] = data_[best];
+      i = best;
+    }
+    data_[i] = last;
+    return result;
+  }
+
+ private:
+  T data_[kCapacity];
+  std::size_t size_ = 0;
+};
+
+template <typename T, auto kPriority, std::size_t kCapacity>
+using BinaryHeapFrontier = HeapFrontier<T, kPriority, kCapacity, 2>;
+
+template <typename T, auto kPriority, std::size_t kCapacity>
+using QuaternaryHeapFrontier = HeapFrontier<T, kPriority, kCapacity, 4>;
+
+// A priority queue of at most `kCapacity` values for a search where every
+// edge costs at most `kMaxStep`, such as Dijkstra's algorithm on a graph with
+// small integer edge weights. Priorities must be integers, and each pushed
+// value must have a priority between that of the last popped value and
+// `kMaxStep` more than it. There is a bucket for each priority in that range,
+// so both push and pop take constant time (aside from skipping over empty
+// buckets, which is bounded by the range of priorities seen over the whole
+// search). Values with equal priority are popped in the opposite order to
+// which they were pushed. Throws if the capacity is exceeded.
+template <typename T, auto kPriority, std::size_t kCapacity, int kMaxStep>
+class BucketFrontier {
+ public:
+  using Priority = FrontierPriority<T, kPriority>;
+  static_assert(std::is_integral_v<Priority>);
+
+  BucketFrontier() {
+    for (Index& head : heads_) head = kNone;
+  }
+
+  bool Empty() const { return size_ == 0; }
+  std::size_t Size() const { return size_; }
+
+  void Push(const T& value) {
+    const Priority priority = std::invoke(kPriority, value);
+    if (Empty()) current_ = priority;
+    assert(current_ <= priority && priority <= current_ + kMaxStep);
+    Index i;
+    if (free_ != kNone) {
+      i = free_;
+      free_ = entries_[i].next;
+    } else if (std::size_t(num_used_) < kCapacity) {
+      i = num_used_++;
+    } else {
+      throw std::runtime_error("frontier is full");
+    }
+    Index& head = heads_[priority % kNumBuckets];
+    entries_[i] = Entry{.value = value, .next = head};
+    head = i;
+    size_++;
+  }
+
+  T Pop() {
+    assert(!Empty());
+    while (heads_[current_ % kNumBuckets] == kNone) current_++;
+    Index& head = heads_[current_ % kNumBuckets];
+    const Index i = head;
+    head = entries_[i].next;
+    entries_[i].next = free_;
+    free_ = i;
+    size_--;
+    return entries_[i].value;
+  }
+
+ private:
+  using Index = int;
+  static constexpr Index kNone = -1;
+  static constexpr int kNumBuckets = kMaxStep + 1;
+
+  // Each bucket is a linked list of entries. Unused entries form another list
+  // starting at `free_`, except for those past `num_used_`, which have never
+  // been used.
+  struct Entry {
+    T value;
+    Index next;
+  };
+
+  Entry entries_[kCapacity];
+  Index heads_[kNumBuckets];
+  Index free_ = kNone;
+  Index num_used_ = 0;
+  std::size_t size_ = 0;
+  // No value in the frontier has a lower priority than this.
+  Priority current_ = 0;
+};
+
+}  // namespace aoc2024
+
+#endif  // AOC2024_FRONTIER_HPP_
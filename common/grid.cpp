@@ -0,0 +1,55 @@
+#include "grid.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string_view>
+
+namespace aoc2024 {
+namespace {
+
+// Returns the width of a grid of text, checking that it is rectangular.
+int GridWidth(std::string_view text) {
+  if (text.empty() || text.back() != '\n') {
+    throw std::runtime_error("bad grid (truncated)");
+  }
+  // This must succeed: the text ends with '\n'.
+  const int width = text.find('\n');
+  if (text.size() % (width + 1) != 0) {
+    throw std::runtime_error("grid is not rectangular");
+  }
+  return width;
+}
+
+}  // namespace
+
+Grid<char> ParseGrid(std::span<char> text) {
+  const int width = GridWidth(std::string_view(text));
+  const int height = text.size() / (width + 1);
+  return Grid<char>(text.data(), width, height, width + 1);
+}
+
+Grid<const char> ParseGrid(std::string_view text) {
+  const int width = GridWidth(text);
+  const int height = text.size() / (width + 1);
+  return Grid<const char>(text.data(), width, height, width + 1);
+}
+
+Task<Grid<char>> ReadGrid(Stream& stream, std::span<char> buffer) {
+  constexpr std::size_t kPadding = kGridPadding / 2;
+  if (buffer.size() <= kGridPadding) throw std::logic_error("buffer too small");
+  const std::span<char> space =
+      buffer.subspan(kPadding, buffer.size() - kGridPadding);
+  const std::span<char> text = co_await stream.Read(space);
+  if (text.size() == space.size()) throw std::runtime_error("grid too big");
+  Grid<char> grid = ParseGrid(text);
+  if (grid.width() > kMaxGridWidth) throw std::runtime_error("grid too wide");
+  // The cells above the first row, including the one before the top left
+  // corner, and those below the last row.
+  const int n = grid.width() + 2;
+  std::fill_n(text.data() - n, n, '\n');
+  std::fill_n(text.data() + text.size(), n, '\n');
+  co_return Grid<char>(text.data(), grid.width(), grid.height(),
+                       grid.stride(), 1);
+}
+
+}  // namespace aoc2024
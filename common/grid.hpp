@@ -0,0 +1,165 @@
+#ifndef AOC2024_GRID_HPP_
+#define AOC2024_GRID_HPP_
+
+#include "coro.hpp"
+#include "stream.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <concepts>
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <type_traits>
+
+namespace aoc2024 {
+
+// Anything with `x` and `y` members, such as the `Vec` type of a solution.
+template <typename V>
+concept GridPoint = requires (V v) {
+  { v.x } -> std::convertible_to<int>;
+  { v.y } -> std::convertible_to<int>;
+};
+
+// A view of a rectangular grid of cells which are stored row by row, `stride`
+// cells apart. Like `std::span`, a `Grid<const T>` is read-only, while copies
+// of a `Grid<T>` refer to the same cells.
+//
+// A grid may have a border of extra cells around every edge which can be
+// accessed as if they were part of the grid. Filling the border with a value
+// which never matches a real cell lets a solution look at the neighbours of any
+// cell without checking that they are in bounds.
+//
+// Cells can be addressed by position or by index. For a cell with index `i`,
+// the neighbours are `i - 1`, `i + 1`, `i - stride()` and `i + stride()`, which
+// is often faster to walk than positions.
+template <typename T>
+class Grid {
+ public:
+  Grid() = default;
+
+  // Refers to cells in place. `origin` points at the top left cell.
+  Grid(T* origin, int width, int height, int stride, int border = 0)
+      : origin_(origin),
+        width_(width),
+        height_(height),
+        stride_(stride),
+        border_(border) {
+    assert(0 <= width && width + border <= stride);
+  }
+
+  // The number of cells needed by `WithBorder`.
+  static constexpr std::size_t BufferSize(int width, int height,
+                                          int border = 1) {
+    return std::size_t(width + 2 * border) * (height + 2 * border);
+  }
+
+  // Lays out a `width` by `height` grid in `buffer` with `border` cells of
+  // padding on every side, all of which (like the cells) are set to `fill`.
+  static Grid WithBorder(std::span<T> buffer, int width, int height,
+                         const T& fill, int border = 1) {
+    const std::size_t size = BufferSize(width, height, border);
+    assert(size <= buffer.size());
+    std::fill_n(buffer.data(), size, fill);
+    const int stride = width + 2 * border;
+    return Grid(buffer.data() + border * stride + border, width, height,
+                stride, border);
+  }
+
+  // Grids of `T` convert to grids of `const T`.
+  operator Grid<const T>() const requires (!std::is_const_v<T>) {
+    return Grid<const T>(origin_, width_, height_, stride_, border_);
+  }
+
+  int width() const { return width_; }
+  int height() const { return height_; }
+  int stride() const { return stride_; }
+  int border() const { return border_; }
+
+  // Whether `(x, y)` is a cell of the grid, rather than the border or outside.
+  bool InBounds(int x, int y) const {
+    return 0 <= x && x < width_ && 0 <= y && y < height_;
+  }
+
+  bool InBounds(GridPoint auto v) const { return InBounds(v.x, v.y); }
+
+  int Index(int x, int y) const { return y * stride_ + x; }
+  int Index(GridPoint auto v) const { return Index(v.x, v.y); }
+
+  // The position of the cell with the given index, which must not be part of
+  // the border.
+  template <GridPoint V>
+  V Position(int index) const {
+    assert(0 <= index && index % stride_ < width_);
+    return V(index % stride_, index / stride_);
+  }
+
+  T& operator[](int index) const {
+    assert(-border_ * (stride_ + 1) <= index &&
+           index < (height_ + border_ - 1) * stride_ + width_ + border_);
+    return origin_[index];
+  }
+
+  T& operator[](int x, int y) const {
+    assert(-border_ <= x && x < width_ + border_);
+    assert(-border_ <= y && y < height_ + border_);
+    return origin_[Index(x, y)];
+  }
+
+  T& operator[](GridPoint auto v) const { return (*this)[v.x, v.y]; }
+
+  // Returns the index of the first cell with the given value, if any.
+  std::optional<int> Find(const T& value) const {
+    for (int y = 0; y < height_; y++) {
+      const T* row = origin_ + Index(0, y);
+      const T* i = std::find(row, row + width_, value);
+      if (i != row + width_) return Index(int(i - row), y);
+    }
+    return std::nullopt;
+  }
+
+  // Sets every cell of this grid to `transform(source[x, y])`. The grids must
+  // be the same size.
+  template <typename U, typename F>
+  void Assign(const Grid<U>& source, F transform) const {
+    assert(source.width() == width_ && source.height() == height_);
+    for (int y = 0; y < height_; y++) {
+      for (int x = 0; x < width_; x++) {
+        (*this)[x, y] = transform(source[x, y]);
+      }
+    }
+  }
+
+  template <typename U>
+  void Assign(const Grid<U>& source) const {
+    Assign(source, [](const U& value) -> const U& { return value; });
+  }
+
+ private:
+  T* origin_ = nullptr;
+  int width_ = 0, height_ = 0, stride_ = 0, border_ = 0;
+};
+
+// Refers in place to a grid of text in which every row ends with '\n'. The
+// newlines are part of the stride but not of the grid, which has no border.
+// Throws if the text is not a rectangular grid.
+Grid<char> ParseGrid(std::span<char> text);
+Grid<const char> ParseGrid(std::string_view text);
+
+// The widest grid which `ReadGrid` accepts.
+constexpr int kMaxGridWidth = 150;
+
+// How much bigger than the input the buffer for `ReadGrid` must be.
+constexpr std::size_t kGridPadding = 2 * (kMaxGridWidth + 2);
+
+// Reads a grid of text (as for `ParseGrid`) into `buffer` and refers to it in
+// place, with a one-cell border of '\n' on every side: the newlines at the end
+// of each row form the left and right edges, and the rest of the border is
+// written into the padding before and after the text. Throws if the input is
+// not a rectangular grid or doesn't fit.
+Task<Grid<char>> ReadGrid(Stream& stream, std::span<char> buffer);
+
+}  // namespace aoc2024
+
+#endif  // AOC2024_GRID_HPP_
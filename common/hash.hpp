@@ -0,0 +1,28 @@
+#ifndef AOC2024_HASH_HPP_
+#define AOC2024_HASH_HPP_
+
+#include <cstdint>
+#include <span>
+
+namespace aoc2024 {
+
+// An incremental 64-bit FNV-1a hash, which identifies puzzle inputs for the
+// answer cache. Feeding in the bytes in several pieces gives the same result.
+class InputHash {
+ public:
+  void Update(std::span<const char> bytes) {
+    for (char c : bytes) value_ = (value_ ^ std::uint8_t(c)) * kPrime;
+  }
+
+  std::uint64_t value() const { return value_; }
+
+ private:
+  static constexpr std::uint64_t kOffsetBasis = 0xcbf2'9ce4'8422'2325;
+  static constexpr std::uint64_t kPrime = 0x100'0000'01b3;
+
+  std::uint64_t value_ = kOffsetBasis;
+};
+
+}  // namespace aoc2024
+
+#endif  // AOC2024_HASH_HPP_
@@ -0,0 +1,197 @@
+#ifndef AOC2024_INTEGERS_HPP_
+#define AOC2024_INTEGERS_HPP_
+
+#include "coro.hpp"
+#include "stream.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+
+namespace aoc2024 {
+namespace integers_internal {
+
+// Eight bytes of input, loaded so that the first byte is the lowest.
+using Word = std::uint64_t;
+static_assert(std::endian::native == std::endian::little);
+
+constexpr Word Repeat(std::uint8_t byte) {
+  return Word(byte) * 0x0101010101010101;
+}
+
+constexpr Word kHighBits = Repeat(0x80);
+
+// Loads the eight bytes of `text` starting at `i`, padding with zeros (which
+// are not digits) past the end.
+inline Word Load(std::string_view text, std::size_t i) {
+  Word word = 0;
+  if (text.size() - i >= 8) {
+    std::memcpy(&word, text.data() + i, 8);
+  } else {
+    std::memcpy(&word, text.data() + i, text.size() - i);
+  }
+  return word;
+}
+
+// Returns a word with the high bit of each byte set iff that byte is a digit.
+// Every step is confined to its own byte, so there are no carries between
+// them.
+constexpr Word DigitMask(Word word) {
+  const Word ascii = word & ~kHighBits;
+  // High bit set iff the byte is at least '0'.
+  const Word at_least_0 = (ascii | kHighBits) - Repeat('0');
+  // High bit set iff the byte is greater than '9'.
+  const Word above_9 = ascii + Repeat(0x80 - ':');
+  return at_least_0 & ~above_9 & ~word & kHighBits;
+}
+
+// Converts eight digit values (not characters), most significant first, into
+// a number by combining adjacent pairs of digits, then of pairs, then of
+// quads.
+constexpr std::uint32_t ParseEightDigits(Word digits) {
+  digits = (digits * 10 + (digits >> 8)) & 0x00FF00FF00FF00FF;
+  digits = (digits * 100 + (digits >> 16)) & 0x0000FFFF0000FFFF;
+  return (digits * 10000 + (digits >> 32)) & 0xFFFFFFFF;
+}
+
+// Moves the high bit of each byte into the low byte, with the first byte's in
+// the lowest bit. The multiplication shifts each bit to a distinct position in
+// the top byte, so none of the partial products overlap.
+constexpr std::uint64_t GatherHighBits(Word mask) {
+  return (mask >> 7) * 0x0102040810204080 >> 56;
+}
+
+// Returns a bitmask of which of the 64 bytes of `text` from `i` are digits.
+inline std::uint64_t DigitBits(std::string_view text, std::size_t i) {
+  std::uint64_t bits = 0;
+  for (int k = 0; k < 8 && i + 8 * k < text.size(); k++) {
+    bits |= GatherHighBits(DigitMask(Load(text, i + 8 * k))) << (8 * k);
+  }
+  return bits;
+}
+
+constexpr std::uint64_t kPowersOf10[] = {
+    1, 10, 100, 1'000, 10'000, 100'000, 1'000'000, 10'000'000, 100'000'000,
+};
+
+// Parses the digits at `text[i]` onwards, advancing `i` past them. Up to eight
+// digits are converted at a time: the low nibble of a digit is its value, and
+// aligning them to the end of the word makes the bytes before them leading
+// zeros. Most integers are shorter than eight digits, so this usually loops
+// once.
+inline std::uint64_t ParseDigits(std::string_view text, std::size_t& i) {
+  std::uint64_t magnitude = 0;
+  int num_digits = 0;
+  while (true) {
+    const Word word = Load(text, i);
+    const int n = std::countr_zero(~DigitMask(word) & kHighBits) / 8;
+    if (n == 0) return magnitude;
+    const Word digits = (word & Repeat(0x0F)) << (8 * (8 - n));
+    magnitude = magnitude * kPowersOf10[n] + ParseEightDigits(digits);
+    num_digits += n;
+    i += n;
+    if (num_digits > std::numeric_limits<std::uint64_t>::digits10) {
+      throw std::runtime_error("integer too long");
+    }
+    if (n < 8) return magnitude;
+  }
+}
+
+template <std::integral T>
+T ToInteger(std::uint64_t magnitude, bool negative) {
+  constexpr std::uint64_t kMax = std::numeric_limits<T>::max();
+  if (magnitude > kMax + negative) {
+    throw std::runtime_error("integer out of range");
+  }
+  return negative ? T(-std::int64_t(magnitude - 1) - 1) : T(magnitude);
+}
+
+struct Extracted {
+  std::size_t num_values;
+  // The number of bytes of the text which were used.
+  std::size_t num_bytes;
+};
+
+// Extracts the integers in `text` into `values`. If `partial` is set, the text
+// is the start of a longer input, so a trailing integer (or sign) which might
+// continue past the end is left unused.
+//
+// The text is classified 64 bytes at a time into a bitmask of digits, which
+// gives the start of every integer in the block up front. This keeps the
+// position of each integer independent of parsing the one before, which would
+// otherwise be a long chain of dependent loads.
+template <std::integral T>
+Extracted Extract(std::string_view text, std::span<T> values, bool partial) {
+  std::size_t num_values = 0;
+  // Whether the last byte of the previous block was a digit.
+  std::uint64_t carry = 0;
+  for (std::size_t block = 0; block < text.size(); block += 64) {
+    const std::uint64_t digits = DigitBits(text, block);
+    std::uint64_t starts = digits & ~(digits << 1 | carry);
+    carry = digits >> 63;
+    while (starts != 0) {
+      const std::size_t start = block + std::countr_zero(starts);
+      starts &= starts - 1;
+      const bool has_sign = start > 0 && text[start - 1] == '-';
+      std::size_t end = start;
+      const std::uint64_t magnitude = ParseDigits(text, end);
+      // Padding past the end is never a digit, so this stops at the end.
+      if (partial && end == text.size()) return {num_values, start - has_sign};
+      if (num_values == values.size()) {
+        throw std::runtime_error("too many integers");
+      }
+      values[num_values++] =
+          ToInteger<T>(magnitude, std::signed_integral<T> && has_sign);
+    }
+  }
+  const bool sign = partial && text.ends_with('-');
+  return {num_values, text.size() - sign};
+}
+
+}  // namespace integers_internal
+
+// Extracts every integer in `text` into a prefix of `values`, which is
+// returned, ignoring whatever separates them. For signed types, a '-' directly
+// before an integer makes it negative. Throws if there are more integers than
+// values or if one is out of range.
+//
+// Bytes are classified eight at a time, and each run of up to eight digits is
+// converted with a few multiplications rather than one digit at a time.
+template <std::integral T, std::size_t N>
+std::span<T> ExtractIntegers(std::string_view text, std::span<T, N> values) {
+  return values.first(
+      integers_internal::Extract<T>(text, values, false).num_values);
+}
+
+// Like `ExtractIntegers`, but for the whole of a stream, which is read in
+// chunks as it arrives.
+template <std::integral T, std::size_t N, ByteStream S>
+Task<std::span<T>> ReadIntegers(S& stream, std::span<T, N> values) {
+  char buffer[256];
+  std::size_t size = 0, num_values = 0;
+  while (true) {
+    const std::span<char> chunk =
+        co_await stream.ReadChunk(std::span(buffer).subspan(size));
+    size += chunk.size();
+    const bool end = chunk.empty();
+    const integers_internal::Extracted extracted =
+        integers_internal::Extract<T>(std::string_view(buffer, size),
+                                      values.subspan(num_values), !end);
+    num_values += extracted.num_values;
+    if (end) co_return values.first(num_values);
+    // Keep any integer which may continue in the next chunk.
+    std::copy(buffer + extracted.num_bytes, buffer + size, buffer);
+    size -= extracted.num_bytes;
+  }
+}
+
+}  // namespace aoc2024
+
+#endif  // AOC2024_INTEGERS_HPP_
@@ -0,0 +1,116 @@
+#include "memory.hpp"
+
+#include "tlsf.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <new>
+
+namespace aoc2024 {
+namespace {
+
+// Written to every word of the unused stack when a region starts.
+constexpr std::uint32_t kStackPaint = 0x57AC'57AC;
+
+// The host's stack is several megabytes, so painting all of it for every
+// request would be slow. This is still far more than the Pico has.
+constexpr std::size_t kMaxPaintedStack = 1024 * 1024;
+
+// Bytes below the painting function's frame address which are left alone,
+// since they hold its own locals (and on x86-64, the red zone).
+constexpr std::size_t kStackMargin = 256;
+
+MemoryWatermark* active_watermarks = nullptr;
+
+// The lowest painted word, which stays valid while any watermark is active.
+std::uint32_t* painted_stack = nullptr;
+
+// The pool is set up on first use, since `operator new` may be called during
+// static initialization.
+Tlsf& Heap() {
+  static Tlsf heap(HeapPool());
+  return heap;
+}
+
+// The frame address of the caller, which is roughly where its stack pointer is.
+[[gnu::always_inline]] inline std::byte* StackPointer() {
+  return static_cast<std::byte*>(__builtin_frame_address(0));
+}
+
+// Paints the stack from `limit` up to just below the caller. This must not call
+// any other function while painting, since its frame would be overwritten.
+[[gnu::noinline]] std::uint32_t* PaintStack(std::byte* limit) {
+  constexpr std::uintptr_t kAlign = alignof(std::uint32_t);
+  const std::uintptr_t top =
+      reinterpret_cast<std::uintptr_t>(StackPointer()) - kStackMargin;
+  const std::uintptr_t bottom = std::max(
+      reinterpret_cast<std::uintptr_t>(limit), top - kMaxPaintedStack);
+  auto* begin = reinterpret_cast<volatile std::uint32_t*>(
+      (bottom + kAlign - 1) & ~(kAlign - 1));
+  auto* end = reinterpret_cast<volatile std::uint32_t*>(top & ~(kAlign - 1));
+  for (volatile std::uint32_t* p = begin; p < end; p++) *p = kStackPaint;
+  return const_cast<std::uint32_t*>(begin);
+}
+
+}  // namespace
+
+void TrackHeapAllocation(std::size_t in_use) {
+  for (MemoryWatermark* w = active_watermarks; w; w = w->next_) {
+    w->heap_peak_ = std::max(w->heap_peak_, in_use);
+  }
+}
+
+MemoryWatermark::MemoryWatermark()
+    : next_(active_watermarks),
+      stack_start_(StackPointer()),
+      stack_available_(stack_start_ - StackLimit()),
+      heap_start_(Heap().in_use()),
+      heap_peak_(heap_start_),
+      heap_available_(Heap().capacity() - heap_start_),
+      heap_allocations_start_(Heap().num_allocations()) {
+  // If another region is already active, its paint is reused so that its
+  // measurement stays intact.
+  if (!active_watermarks) painted_stack = PaintStack(StackLimit());
+  active_watermarks = this;
+}
+
+MemoryWatermark::~MemoryWatermark() {
+  MemoryWatermark** w = &active_watermarks;
+  while (*w != this) w = &(*w)->next_;
+  *w = next_;
+}
+
+MemoryUsage MemoryWatermark::Measure() const {
+  const std::uint32_t* p = painted_stack;
+  while (*p == kStackPaint) p++;
+  const auto* deepest = reinterpret_cast<const std::byte*>(p);
+  return MemoryUsage{
+      .stack_used = std::size_t(std::max<std::ptrdiff_t>(
+          stack_start_ - deepest, 0)),
+      .stack_available = stack_available_,
+      .heap_used = heap_peak_ - heap_start_,
+      .heap_available = heap_available_,
+      .heap_in_use = Heap().in_use(),
+      .heap_largest_free = Heap().LargestFreeBlock(),
+      .heap_allocations =
+          std::size_t(Heap().num_allocations() - heap_allocations_start_),
+  };
+}
+
+}  // namespace aoc2024
+
+// The global allocation functions are replaced so that the heap is a `Tlsf`,
+// which `MemoryWatermark` can measure. The other forms of `new` and `delete`
+// forward to these. The C library's `malloc` is left alone, and serves the C
+// library itself from whatever memory `HeapPool()` leaves for it.
+void* operator new(std::size_t size) {
+  aoc2024::Tlsf& heap = aoc2024::Heap();
+  void* p = heap.Allocate(size);
+  if (!p) throw std::bad_alloc();
+  aoc2024::TrackHeapAllocation(heap.in_use());
+  return p;
+}
+
+void operator delete(void* p) noexcept { aoc2024::Heap().Free(p); }
+
+void operator delete(void* p, std::size_t) noexcept { operator delete(p); }
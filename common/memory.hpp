@@ -0,0 +1,71 @@
+#ifndef AOC2024_MEMORY_HPP_
+#define AOC2024_MEMORY_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace aoc2024 {
+
+// The peak memory usage over a region of the program, in bytes.
+struct MemoryUsage {
+  // The deepest that the stack went below the point where the region started,
+  // and how much stack there was below that point.
+  std::size_t stack_used, stack_available;
+  // The most heap that was in use at once on top of what was already in use
+  // when the region started, and how much of the heap was free at that point.
+  std::size_t heap_used, heap_available;
+  // The heap in use by the whole program at the end of the region, and the
+  // largest free block at that point. If the largest free block shrinks
+  // while the heap in use stays the same, the heap is fragmenting.
+  std::size_t heap_in_use, heap_largest_free;
+  // The number of allocations made during the region.
+  std::size_t heap_allocations;
+};
+
+// Measures the peak stack and heap usage between construction and `Measure()`:
+//
+//     MemoryWatermark watermark;
+//     co_await Solve(...);
+//     const MemoryUsage usage = watermark.Measure();
+//
+// The unused stack below the caller is painted with a pattern which is checked
+// afterwards, so only the calling core's stack is measured (the other core's
+// stack for parallel loops is not). Heap usage is tracked by the global
+// `operator new`, which allocates from a `Tlsf` over `HeapPool()` and must
+// only be used by the core which runs the event loop. Regions may overlap, such
+// as when the server solves several requests concurrently: each of them then
+// includes the usage of the others, so the results are upper bounds.
+class MemoryWatermark {
+ public:
+  MemoryWatermark();
+  ~MemoryWatermark();
+
+  // Not copyable.
+  MemoryWatermark(const MemoryWatermark&) = delete;
+  MemoryWatermark& operator=(const MemoryWatermark&) = delete;
+
+  MemoryUsage Measure() const;
+
+ private:
+  friend void TrackHeapAllocation(std::size_t in_use);
+
+  // The active watermarks form a list, which every allocation updates.
+  MemoryWatermark* next_;
+  std::byte* stack_start_;
+  std::size_t stack_available_;
+  std::size_t heap_start_, heap_peak_, heap_available_;
+  std::uint64_t heap_allocations_start_;
+};
+
+// The lowest address which the calling core's stack can grow down to.
+// Implemented per platform.
+std::byte* StackLimit();
+
+// The memory for the global `operator new`, which is requested on the first
+// allocation. Implemented per platform.
+std::span<std::byte> HeapPool();
+
+}  // namespace aoc2024
+
+#endif  // AOC2024_MEMORY_HPP_
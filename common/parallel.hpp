@@ -0,0 +1,222 @@
+#ifndef AOC2024_PARALLEL_HPP_
+#define AOC2024_PARALLEL_HPP_
+
+#include <algorithm>
+#include <cassert>
+#include <concepts>
+#include <coroutine>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+
+namespace aoc2024 {
+
+// The number of cores which run parallel loops, including the caller. The Pico
+// has two cores, and the host build mirrors that so that it behaves the same.
+inline constexpr int kNumCores = 2;
+
+// The maximum number of chunks that a parallel loop is split into.
+inline constexpr int kMaxChunks = 32;
+
+// Starts the worker cores which help with parallel loops. Until this is called,
+// parallel loops run entirely on the calling core. Implemented per platform.
+void ExecutorInit();
+
+// Splits [begin, end) into at most `kMaxChunks` chunks and calls
+// `func(data, chunk, chunk_begin, chunk_end)` for each of them, spread across
+// all cores. Returns once every chunk has finished. `func` must not throw and
+// must not allocate, since it may run on a core which the rest of the program
+// (including the allocator) does not expect. Implemented per platform.
+using ChunkFunction = void (*)(void* data, int chunk, int begin, int end);
+void RunParallel(int begin, int end, void* data, ChunkFunction func);
+
+// Calls `fn(i)` for every `i` in [begin, end) using all cores:
+//
+//     co_await ParallelFor(0, n, [&](int i) { ... });
+//
+// The awaiting coroutine's core takes part in the loop, so this completes
+// without suspending. The same restrictions as `RunParallel` apply to `fn`.
+template <std::invocable<int> F>
+class [[nodiscard]] ParallelForAwaitable {
+ public:
+  ParallelForAwaitable(int begin, int end, F fn)
+      : begin_(begin), end_(end), fn_(std::move(fn)) {}
+
+  bool await_ready() const { return false; }
+
+  bool await_suspend(std::coroutine_handle<>) {
+    RunParallel(begin_, end_, &fn_, [](void* data, int, int begin, int end) {
+      F& fn = *static_cast<F*>(data);
+      for (int i = begin; i < end; i++) fn(i);
+    });
+    return false;
+  }
+
+  void await_resume() {}
+
+ private:
+  int begin_, end_;
+  F fn_;
+};
+
+template <std::invocable<int> F>
+ParallelForAwaitable<std::decay_t<F>> ParallelFor(int begin, int end,
+                                                  F&& fn) {
+  return ParallelForAwaitable<std::decay_t<F>>(begin, end,
+                                               std::forward<F>(fn));
+}
+
+// Like `ParallelFor`, but yields the sum of `fn(i)` over [begin, end).
+template <typename T, std::invocable<int> F>
+class [[nodiscard]] ParallelSumAwaitable {
+ public:
+  ParallelSumAwaitable(int begin, int end, F fn)
+      : begin_(begin), end_(end), fn_(std::move(fn)) {}
+
+  bool await_ready() const { return false; }
+
+  bool await_suspend(std::coroutine_handle<>) {
+    RunParallel(begin_, end_, this,
+                [](void* data, int chunk, int begin, int end) {
+                  auto& self = *static_cast<ParallelSumAwaitable*>(data);
+                  T total = {};
+                  for (int i = begin; i < end; i++) total += self.fn_(i);
+                  self.partial_[chunk] = total;
+                });
+    return false;
+  }
+
+  T await_resume() {
+    T total = {};
+    for (const T& value : partial_) total += value;
+    return total;
+  }
+
+ private:
+  int begin_, end_;
+  F fn_;
+  // Each chunk writes its own entry, so no synchronisation is needed.
+  T partial_[kMaxChunks] = {};
+};
+
+template <typename T, std::invocable<int> F>
+ParallelSumAwaitable<T, std::decay_t<F>> ParallelSum(int begin, int end,
+                                                     F&& fn) {
+  return ParallelSumAwaitable<T, std::decay_t<F>>(begin, end,
+                                                  std::forward<F>(fn));
+}
+
+// The work-stealing scheduler behind `RunParallel`, shared by the platform
+// implementations. Each core owns a deque of chunks: the owner pushes and pops
+// at the back while idle cores steal from the front. The platform provides:
+//
+//   * `Platform::Lock`: a BasicLockable which works across cores.
+//   * `Platform::CurrentCore()`: the index of the calling core.
+//   * `Platform::Wake()`: wakes any cores which are waiting for work.
+//   * `Platform::Wait(core)`: waits until `Wake()` has been called since the
+//     last time `core` waited. This may also return spuriously.
+template <typename Platform>
+class WorkStealingExecutor {
+ public:
+  void Run(int begin, int end, void* data, ChunkFunction func) {
+    const int n = end - begin;
+    if (n <= 0) return;
+    const int core = Platform::CurrentCore();
+    const int num_chunks = std::min(n, kMaxChunks);
+    Loop loop{.data = data, .func = func, .owner = core,
+              .remaining = num_chunks};
+    for (int i = 0; i < num_chunks; i++) {
+      Push(core, Chunk{.loop = &loop, .index = i,
+                       .begin = begin + n * i / num_chunks,
+                       .end = begin + n * (i + 1) / num_chunks});
+    }
+    Platform::Wake();
+    // Help out until every chunk is finished. The last few chunks may still be
+    // running on other cores after the deques are empty.
+    while (true) {
+      if (std::optional<Chunk> chunk = Take(core)) {
+        Execute(*chunk);
+        continue;
+      }
+      std::lock_guard lock(queues_[core].lock);
+      if (loop.remaining == 0) return;
+    }
+  }
+
+  // Runs chunks on behalf of other cores forever.
+  [[noreturn]] void Work(int core) {
+    while (true) {
+      if (std::optional<Chunk> chunk = Take(core)) {
+        Execute(*chunk);
+      } else {
+        Platform::Wait(core);
+      }
+    }
+  }
+
+ private:
+  struct Loop {
+    void* data;
+    ChunkFunction func;
+    // The core which started the loop. `remaining` is guarded by its lock.
+    int owner;
+    int remaining;
+  };
+
+  struct Chunk {
+    Loop* loop;
+    int index, begin, end;
+  };
+
+  // A fixed-capacity deque stored as a ring buffer.
+  struct Queue {
+    typename Platform::Lock lock;
+    Chunk chunks[kMaxChunks];
+    int front = 0, size = 0;
+  };
+
+  void Push(int core, Chunk chunk) {
+    Queue& queue = queues_[core];
+    std::lock_guard lock(queue.lock);
+    assert(queue.size < kMaxChunks);
+    queue.chunks[(queue.front + queue.size++) % kMaxChunks] = chunk;
+  }
+
+  // Pops a chunk from the back of the core's own deque, or failing that,
+  // steals one from the front of another core's deque.
+  std::optional<Chunk> Take(int core) {
+    {
+      Queue& queue = queues_[core];
+      std::lock_guard lock(queue.lock);
+      if (queue.size > 0) {
+        return queue.chunks[(queue.front + --queue.size) % kMaxChunks];
+      }
+    }
+    for (int i = 1; i < kNumCores; i++) {
+      Queue& queue = queues_[(core + i) % kNumCores];
+      std::lock_guard lock(queue.lock);
+      if (queue.size > 0) {
+        const Chunk chunk = queue.chunks[queue.front];
+        queue.front = (queue.front + 1) % kMaxChunks;
+        queue.size--;
+        return chunk;
+      }
+    }
+    return std::nullopt;
+  }
+
+  void Execute(const Chunk& chunk) {
+    Loop& loop = *chunk.loop;
+    loop.func(loop.data, chunk.index, chunk.begin, chunk.end);
+    // Once `remaining` reaches zero, the owner may return and destroy `loop`,
+    // so it must not be touched after this.
+    std::lock_guard lock(queues_[loop.owner].lock);
+    loop.remaining--;
+  }
+
+  Queue queues_[kNumCores];
+};
+
+}  // namespace aoc2024
+
+#endif  // AOC2024_PARALLEL_HPP_
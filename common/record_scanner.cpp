@@ -0,0 +1,16 @@
+#include "record_scanner.hpp"
+
+namespace aoc2024 {
+
+Task<bool> RecordScanner::Fill() {
+  constexpr std::size_t kMinBytes = SegmentedInput::kMaxRecordSize;
+  if (input_.size() >= kMinBytes) co_return true;
+  // Release what has been scanned so far. This invalidates the segments, so
+  // they must be received again along with any new data. Once the stream has
+  // ended, `Receive` completes immediately with whatever is left.
+  stream_.Consume(input_.consumed());
+  input_ = SegmentedInput(co_await stream_.Receive(kMinBytes));
+  co_return !input_.empty();
+}
+
+}  // namespace aoc2024
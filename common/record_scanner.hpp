@@ -0,0 +1,41 @@
+#ifndef AOC2024_RECORD_SCANNER_HPP_
+#define AOC2024_RECORD_SCANNER_HPP_
+
+#include "coro.hpp"
+#include "scan.hpp"
+#include "stream.hpp"
+
+namespace aoc2024 {
+
+// Scans records directly out of the receive buffers of a stream, without
+// copying the input into a buffer first. Each record must be shorter than
+// `SegmentedInput::kMaxRecordSize`. Neither threadsafe nor reentrant.
+//
+//     RecordScanner scanner(stream);
+//     while (co_await scanner.Fill()) {
+//       if (!ScanPrefix(scanner.input(), "{},{}\n", x, y)) ...
+//     }
+class RecordScanner {
+ public:
+  explicit RecordScanner(Stream& stream) : stream_(stream) {}
+
+  // Not copyable.
+  RecordScanner(const RecordScanner&) = delete;
+  RecordScanner& operator=(const RecordScanner&) = delete;
+
+  // Waits until either a whole record is available in `input()` or the stream
+  // has ended. Yields false if there is no more input.
+  Task<bool> Fill();
+
+  // The received input which has not yet been scanned. Scanning from this
+  // consumes bytes from the stream.
+  SegmentedInput& input() { return input_; }
+
+ private:
+  Stream& stream_;
+  SegmentedInput input_;
+};
+
+}  // namespace aoc2024
+
+#endif  // AOC2024_RECORD_SCANNER_HPP_
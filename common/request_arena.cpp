@@ -0,0 +1,45 @@
+#include "request_arena.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <new>
+
+namespace aoc2024 {
+
+void RequestArena::Reset() {
+  while (blocks_) {
+    Block* previous = blocks_->previous;
+    ::operator delete(blocks_);
+    blocks_ = previous;
+  }
+  next_ = buffer_.data();
+  end_ = buffer_.data() + buffer_.size();
+  used_ = 0;
+}
+
+void* RequestArena::do_allocate(std::size_t size, std::size_t alignment) {
+  auto aligned = [&](std::byte* p) {
+    const std::uintptr_t address = reinterpret_cast<std::uintptr_t>(p);
+    return p + (-address & (alignment - 1));
+  };
+  std::byte* result = aligned(next_);
+  if (result > end_ || std::size_t(end_ - result) < size) {
+    // Take a new block from the heap which is big enough for this allocation.
+    // Large allocations get a block of their own size, so that a big array
+    // doesn't leave a lot of the heap unused.
+    const std::size_t block_size =
+        std::max(block_size_, sizeof(Block) + alignment + size);
+    blocks_ = new (::operator new(block_size))
+        Block{.previous = blocks_};
+    overflows_++;
+    next_ = reinterpret_cast<std::byte*>(blocks_ + 1);
+    end_ = reinterpret_cast<std::byte*>(blocks_) + block_size;
+    result = aligned(next_);
+  }
+  used_ += result + size - next_;
+  high_water_ = std::max(high_water_, used_);
+  next_ = result + size;
+  return result;
+}
+
+}  // namespace aoc2024
@@ -0,0 +1,83 @@
+#ifndef AOC2024_REQUEST_ARENA_HPP_
+#define AOC2024_REQUEST_ARENA_HPP_
+
+#include <cstddef>
+#include <memory_resource>
+#include <span>
+
+namespace aoc2024 {
+
+// A bump allocator for the scratch memory of a single request, for use with
+// `std::pmr` containers. Deallocation does nothing: everything is freed at once
+// by `Reset()` once the request is finished, so solutions never go through
+// the global heap on their hot paths and nothing they allocate outlives the
+// request to fragment it.
+//
+// Allocations come from `buffer` first. Once that is full, the arena takes
+// blocks of at least `block_size` bytes from the heap, which `Reset()`
+// returns. Neither threadsafe nor reentrant.
+class RequestArena final : public std::pmr::memory_resource {
+ public:
+  static constexpr std::size_t kDefaultBlockSize = 4096;
+
+  explicit RequestArena(std::span<std::byte> buffer,
+                        std::size_t block_size = kDefaultBlockSize)
+      : buffer_(buffer), block_size_(block_size) {
+    Reset();
+  }
+
+  // An arena which takes all of its memory from the heap, and so holds none
+  // at all until something is allocated from it.
+  explicit RequestArena(std::size_t block_size)
+      : RequestArena(std::span<std::byte>(), block_size) {}
+
+  ~RequestArena() { Reset(); }
+
+  // Not copyable.
+  RequestArena(const RequestArena&) = delete;
+  RequestArena& operator=(const RequestArena&) = delete;
+
+  // Frees everything which has been allocated. This takes constant time unless
+  // the arena had to take blocks from the heap.
+  void Reset();
+
+  // The number of bytes which have been allocated since the last reset,
+  // including padding.
+  std::size_t used() const { return used_; }
+
+  // The most bytes that have ever been in use.
+  std::size_t high_water() const { return high_water_; }
+
+  // The number of blocks which have been taken from the heap.
+  int overflows() const { return overflows_; }
+
+ private:
+  // Each block taken from the heap starts with a header, which links it to the
+  // block before.
+  struct alignas(std::max_align_t) Block {
+    Block* previous;
+  };
+
+  void* do_allocate(std::size_t size, std::size_t alignment) override;
+  void do_deallocate(void*, std::size_t, std::size_t) override {}
+  bool do_is_equal(
+      const std::pmr::memory_resource& other) const noexcept override {
+    return this == &other;
+  }
+
+  std::span<std::byte> buffer_;
+  // The smallest block which is taken from the heap.
+  std::size_t block_size_;
+  // The most recent block from the heap, if any.
+  Block* blocks_ = nullptr;
+  // The unused part of the current block (or `buffer_`).
+  std::byte* next_ = nullptr;
+  std::byte* end_ = nullptr;
+  std::size_t used_ = 0;
+  std::size_t high_water_ = 0;
+  int overflows_ = 0;
+};
+
+}  // namespace aoc2024
+
+#endif  // AOC2024_REQUEST_ARENA_HPP_
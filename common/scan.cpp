@@ -1,5 +1,6 @@
 #include "scan.hpp"
 
+#include <algorithm>
 #include <cassert>
 #include <stdexcept>
 
@@ -51,6 +52,49 @@ bool VScanPrefix(std::string_view& input, std::string_view format,
   return true;
 }
 
+SegmentedInput::SegmentedInput(std::span<const std::string_view> segments)
+    : segments_(segments) {
+  for (std::string_view segment : segments) size_ += segment.size();
+  // Skip any empty segments so that the front segment is never exhausted.
+  Consume(0);
+}
+
+std::string_view SegmentedInput::Peek() {
+  if (segments_.empty()) return {};
+  const std::string_view front = segments_.front().substr(offset_);
+  if (front.size() >= kMaxRecordSize || front.size() == size_) return front;
+  // The next record may straddle the boundary between segments, so copy the
+  // start of the input into the window.
+  std::size_t n = 0;
+  for (std::size_t i = 0; n < kMaxRecordSize && i < segments_.size(); i++) {
+    const std::string_view segment =
+        i == 0 ? front : segments_[i].substr(0, kMaxRecordSize - n);
+    std::ranges::copy(segment, window_ + n);
+    n += segment.size();
+  }
+  return std::string_view(window_, n);
+}
+
+void SegmentedInput::Consume(std::size_t n) {
+  assert(n <= size_);
+  size_ -= n;
+  consumed_ += n;
+  offset_ += n;
+  while (!segments_.empty() && offset_ >= segments_.front().size()) {
+    offset_ -= segments_.front().size();
+    segments_ = segments_.subspan(1);
+  }
+}
+
+bool VScanPrefix(SegmentedInput& input, std::string_view format,
+                 std::span<const ArgumentParser> args) {
+  const std::string_view window = input.Peek();
+  std::string_view remaining = window;
+  if (!VScanPrefix(remaining, format, args)) return false;
+  input.Consume(window.size() - remaining.size());
+  return true;
+}
+
 bool VScan(std::string_view input, std::string_view format,
            std::span<const ArgumentParser> args) {
   return VScanPrefixImpl(input, format, args) && input.empty();
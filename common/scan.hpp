@@ -3,8 +3,11 @@
 
 #include <charconv>
 #include <concepts>
+#include <cstddef>
 #include <span>
+#include <stdexcept>
 #include <string_view>
+#include <utility>
 
 namespace aoc2024 {
 
@@ -39,8 +42,44 @@ class ArgumentParser {
   bool (*func_)(std::string_view& format, void* data);
 };
 
+// Input which is split across several segments, such as a chain of network
+// buffers. This allows input to be scanned without first copying all of it
+// into one contiguous buffer. Scanning from the middle of a segment is
+// zero-copy, but a record which straddles two segments is stitched together
+// in a small window, so a single scan may consume at most `kMaxRecordSize`
+// bytes.
+class SegmentedInput {
+ public:
+  static constexpr std::size_t kMaxRecordSize = 128;
+
+  SegmentedInput() = default;
+  explicit SegmentedInput(std::span<const std::string_view> segments);
+
+  bool empty() const { return size_ == 0; }
+  std::size_t size() const { return size_; }
+
+  // The number of bytes which have been consumed so far.
+  std::size_t consumed() const { return consumed_; }
+
+  // Returns a contiguous view of at least the first
+  // `min(size(), kMaxRecordSize)` bytes of the input.
+  std::string_view Peek();
+
+  // Discards the first `n` bytes of the input.
+  void Consume(std::size_t n);
+
+ private:
+  std::span<const std::string_view> segments_;
+  // The offset of the first unconsumed byte in `segments_.front()`.
+  std::size_t offset_ = 0;
+  std::size_t size_ = 0, consumed_ = 0;
+  char window_[kMaxRecordSize];
+};
+
 bool VScanPrefix(std::string_view& input, std::string_view format,
                  std::span<const ArgumentParser> args);
+bool VScanPrefix(SegmentedInput& input, std::string_view format,
+                 std::span<const ArgumentParser> args);
 bool VScan(std::string_view input, std::string_view format,
            std::span<const ArgumentParser> args);
 
@@ -51,12 +90,104 @@ bool ScanPrefix(std::string_view& input, std::string_view format,
   return VScanPrefix(input, format, std::span(parsers, sizeof...(args)));
 }
 
+template <Scannable... Args>
+bool ScanPrefix(SegmentedInput& input, std::string_view format,
+                Args&... args) {
+  const ArgumentParser parsers[] = {ArgumentParser(args)...};
+  return VScanPrefix(input, format, std::span(parsers, sizeof...(args)));
+}
+
 template <Scannable... Args>
 bool Scan(std::string_view input, std::string_view format, Args&... args) {
   const ArgumentParser parsers[] = {ArgumentParser(args)...};
   return VScan(input, format, parsers);
 }
 
+// A format string which is parsed at compile time, for use as a template
+// argument: `ScanPrefix<"p={},{}">(input, x, y)`. Each literal is matched with
+// a single comparison of known size and each value is parsed by a direct call
+// to `ScanValue`, rather than interpreting the format string on every call.
+template <std::size_t N>
+struct FormatString {
+  consteval FormatString(const char (&text)[N]) {
+    std::size_t size = 0;
+    for (std::size_t i = 0; i + 1 < N; i++) {
+      const char c = text[i];
+      if (c != '{' && c != '}') {
+        literals[size++] = c;
+        continue;
+      }
+      if (i + 2 == N) throw std::logic_error("bad format string");
+      if (text[i + 1] == c) {
+        // An escaped literal like `{{` or `}}`.
+        literals[size++] = c;
+      } else if (c == '{' && text[i + 1] == '}') {
+        literal_ends[num_args++] = size;
+      } else {
+        throw std::logic_error("unescaped '}'");
+      }
+      i++;
+    }
+    literal_ends[num_args] = size;
+  }
+
+  // The literal which precedes the `i`th placeholder, or which follows the
+  // last one if `i == num_args`.
+  constexpr std::string_view literal(std::size_t i) const {
+    const std::size_t begin = i == 0 ? 0 : literal_ends[i - 1];
+    return std::string_view(literals + begin, literal_ends[i] - begin);
+  }
+
+  // These must be public for this to be usable as a template argument.
+  char literals[N] = {};
+  std::size_t literal_ends[N] = {};
+  std::size_t num_args = 0;
+};
+
+namespace scan_internal {
+
+template <FormatString kFormat, std::size_t... kArgs, Scannable... Args>
+bool ScanPrefixImpl(std::string_view& input, std::index_sequence<kArgs...>,
+                    Args&... args) {
+  const auto consume = [&input](std::string_view literal) {
+    if (!input.starts_with(literal)) return false;
+    input.remove_prefix(literal.size());
+    return true;
+  };
+  return consume(kFormat.literal(0)) &&
+         ((ScanValue(input, args) && consume(kFormat.literal(kArgs + 1))) &&
+          ...);
+}
+
+}  // namespace scan_internal
+
+template <FormatString kFormat, Scannable... Args>
+bool ScanPrefix(std::string_view& input, Args&... args) {
+  static_assert(kFormat.num_args == sizeof...(Args),
+                "wrong number of arguments for the format string");
+  std::string_view copy = input;
+  if (!scan_internal::ScanPrefixImpl<kFormat>(
+          copy, std::index_sequence_for<Args...>(), args...)) {
+    return false;
+  }
+  input = copy;
+  return true;
+}
+
+template <FormatString kFormat, Scannable... Args>
+bool ScanPrefix(SegmentedInput& input, Args&... args) {
+  const std::string_view window = input.Peek();
+  std::string_view remaining = window;
+  if (!ScanPrefix<kFormat>(remaining, args...)) return false;
+  input.Consume(window.size() - remaining.size());
+  return true;
+}
+
+template <FormatString kFormat, Scannable... Args>
+bool Scan(std::string_view input, Args&... args) {
+  return ScanPrefix<kFormat>(input, args...) && input.empty();
+}
+
 }  // namespace aoc2024
 
 #endif  // AOC2024_SCAN_HPP_
@@ -0,0 +1,73 @@
+#ifndef AOC2024_SCHEDULE_HPP_
+#define AOC2024_SCHEDULE_HPP_
+
+#include <coroutine>
+#include <cstdint>
+#include <utility>
+
+namespace aoc2024 {
+
+bool SchedulerInit();
+
+// An intrusive queue node for a unit of work which runs in the background. The
+// task must stay alive and at the same address from when it is scheduled until
+// it runs.
+struct BackgroundTask {
+  void* data;
+  void (*func)(void*);
+  BackgroundTask* next = nullptr;
+
+  void Schedule();
+};
+
+// Counters for the scheduler, to check that the hot paths don't allocate.
+struct SchedulerStats {
+  // The number of background tasks which have been scheduled.
+  std::uint32_t scheduled = 0;
+  // The number of those tasks which were allocated on the heap.
+  std::uint32_t allocated = 0;
+  // The number of coroutine frames which were allocated on the heap, rather
+  // than from a `FrameArena`.
+  std::uint32_t frames_allocated = 0;
+};
+
+SchedulerStats GetSchedulerStats();
+
+// Records a heap-allocated task in the stats. Used by `Schedule(F&&)`.
+void CountAllocatedTask();
+
+// Schedules `handle` to be resumed, using `task` as the queue node. This never
+// allocates: awaitables embed the task alongside the handle of the coroutine
+// which is awaiting them.
+inline void Schedule(BackgroundTask& task, std::coroutine_handle<> handle) {
+  task.data = handle.address();
+  task.func = [](void* data) {
+    std::coroutine_handle<>::from_address(data).resume();
+  };
+  task.Schedule();
+}
+
+// Schedules an arbitrary function. This allocates, so prefer the overload above
+// for anything which happens routinely.
+template <typename F>
+void Schedule(F&& f) {
+  using T = std::decay_t<F>;
+  struct State {
+    BackgroundTask task = {};
+    T func;
+  };
+  auto* state = new State{.func = std::forward<F>(f)};
+  CountAllocatedTask();
+  state->task.data = state;
+  state->task.func = [](void* data) {
+    auto* state = reinterpret_cast<State*>(data);
+    T func = std::move(state->func);
+    delete state;
+    func();
+  };
+  state->task.Schedule();
+}
+
+}  // namespace aoc2024
+
+#endif  // AOC2024_SCHEDULE_HPP_
@@ -0,0 +1,83 @@
+#ifndef AOC2024_SEMAPHORE_HPP_
+#define AOC2024_SEMAPHORE_HPP_
+
+#include "schedule.hpp"
+
+#include <cassert>
+#include <coroutine>
+
+namespace aoc2024 {
+
+// A counting semaphore for coroutines. Coroutines which are waiting to acquire
+// the semaphore are resumed in FIFO order. Neither threadsafe nor reentrant.
+class Semaphore {
+ public:
+  explicit Semaphore(int count) : count_(count) {}
+
+  // Not copyable.
+  Semaphore(const Semaphore&) = delete;
+  Semaphore& operator=(const Semaphore&) = delete;
+
+  // Waits until the count is positive and then decrements it.
+  class AcquireAwaitable;
+  AcquireAwaitable Acquire();
+
+  // Increments the count, or hands it directly to the longest waiter.
+  void Release();
+
+ private:
+  int count_;
+  AcquireAwaitable* head_ = nullptr;
+  AcquireAwaitable* tail_ = nullptr;
+};
+
+class [[nodiscard]] Semaphore::AcquireAwaitable {
+ public:
+  bool await_ready() const { return false; }
+
+  bool await_suspend(std::coroutine_handle<> awaiter) {
+    if (semaphore_.count_ > 0) {
+      semaphore_.count_--;
+      return false;
+    }
+    awaiter_ = awaiter;
+    if (semaphore_.tail_) {
+      semaphore_.tail_->next_ = this;
+    } else {
+      semaphore_.head_ = this;
+    }
+    semaphore_.tail_ = this;
+    return true;
+  }
+
+  void await_resume() {}
+
+ private:
+  friend class Semaphore;
+
+  explicit AcquireAwaitable(Semaphore& semaphore) : semaphore_(semaphore) {}
+
+  Semaphore& semaphore_;
+  std::coroutine_handle<> awaiter_;
+  BackgroundTask resume_;
+  AcquireAwaitable* next_ = nullptr;
+};
+
+inline Semaphore::AcquireAwaitable Semaphore::Acquire() {
+  return AcquireAwaitable(*this);
+}
+
+inline void Semaphore::Release() {
+  if (!head_) {
+    count_++;
+    return;
+  }
+  AcquireAwaitable* const waiter = head_;
+  head_ = waiter->next_;
+  if (!head_) tail_ = nullptr;
+  Schedule(waiter->resume_, waiter->awaiter_);
+}
+
+}  // namespace aoc2024
+
+#endif  // AOC2024_SEMAPHORE_HPP_
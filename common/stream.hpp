@@ -0,0 +1,397 @@
+#ifndef AOC2024_STREAM_HPP_
+#define AOC2024_STREAM_HPP_
+
+#include "coro.hpp"
+#include "hash.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <concepts>
+#include <cstddef>
+#include <coroutine>
+#include <new>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace aoc2024 {
+
+// An awaitable which yields a `T`.
+template <typename A, typename T>
+concept AwaitableOf = requires (A awaitable, std::coroutine_handle<> handle) {
+  { awaitable.await_ready() } -> std::convertible_to<bool>;
+  awaitable.await_suspend(handle);
+  { awaitable.await_resume() } -> std::convertible_to<T>;
+};
+
+// A type-erased awaitable which yields a `T`. The awaitable which it wraps is
+// held inline rather than in a coroutine frame, so forwarding an operation
+// through it (as `Stream` does) allocates nothing.
+template <typename T>
+class [[nodiscard]] AnyAwaitable {
+ public:
+  // Large enough for the socket awaitables on either platform.
+  static constexpr std::size_t kMaxSize = 96;
+
+  // Wraps the awaitable returned by `make()`, which is constructed in place so
+  // that it never has to be moved.
+  template <std::invocable F>
+  explicit AnyAwaitable(F&& make) {
+    using A = std::invoke_result_t<F>;
+    static_assert(AwaitableOf<A, T>);
+    static_assert(sizeof(A) <= kMaxSize &&
+                      alignof(A) <= alignof(std::max_align_t),
+                  "awaitable is too large to store inline");
+    new (storage_) A(std::forward<F>(make)());
+    ops_ = &kOps<A>;
+  }
+
+  ~AnyAwaitable() { ops_->destroy(storage_); }
+
+  // Not copyable.
+  AnyAwaitable(const AnyAwaitable&) = delete;
+  AnyAwaitable& operator=(const AnyAwaitable&) = delete;
+
+  bool await_ready() { return ops_->ready(storage_); }
+
+  std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiter) {
+    return ops_->suspend(storage_, awaiter);
+  }
+
+  T await_resume() { return ops_->resume(storage_); }
+
+ private:
+  struct Ops {
+    bool (*ready)(void* awaitable);
+    std::coroutine_handle<> (*suspend)(void* awaitable,
+                                       std::coroutine_handle<> awaiter);
+    T (*resume)(void* awaitable);
+    void (*destroy)(void* awaitable);
+  };
+
+  // `await_suspend` may return void, bool or a handle. They are all turned
+  // into a handle to resume next.
+  template <typename A>
+  static std::coroutine_handle<> Suspend(A& awaitable,
+                                         std::coroutine_handle<> awaiter) {
+    using Result = decltype(awaitable.await_suspend(awaiter));
+    if constexpr (std::is_void_v<Result>) {
+      awaitable.await_suspend(awaiter);
+      return std::noop_coroutine();
+    } else if constexpr (std::is_same_v<Result, bool>) {
+      if (awaitable.await_suspend(awaiter)) return std::noop_coroutine();
+      return awaiter;
+    } else {
+      return awaitable.await_suspend(awaiter);
+    }
+  }
+
+  template <typename A>
+  static constexpr Ops kOps = {
+      .ready = [](void* p) -> bool {
+        return static_cast<A*>(p)->await_ready();
+      },
+      .suspend =
+          [](void* p, std::coroutine_handle<> awaiter) {
+            return Suspend(*static_cast<A*>(p), awaiter);
+          },
+      .resume = [](void* p) -> T {
+        return static_cast<A*>(p)->await_resume();
+      },
+      .destroy = [](void* p) { static_cast<A*>(p)->~A(); },
+  };
+
+  alignas(std::max_align_t) std::byte storage_[kMaxSize];
+  const Ops* ops_;
+};
+
+// A ByteStream is a bidirectional stream of bytes, such as a TCP connection.
+//
+//   * `Read(buffer)` reads bytes into the buffer until either the buffer is
+//     full or the stream has ended, yielding the prefix that was filled.
+//   * `ReadChunk(buffer)` is like `Read`, but completes as soon as any bytes
+//     are available. An empty result indicates the end of the stream.
+//   * `Receive(min_bytes)` waits until at least `min_bytes` bytes are
+//     available and yields a view of all available bytes as a sequence of
+//     segments, without copying them. Fewer than `min_bytes` bytes are only
+//     yielded at the end of the stream. The view is invalidated by any other
+//     operation on the stream.
+//   * `Consume(n)` discards the first `n` bytes yielded by `Receive`.
+//   * `Write(bytes)` writes all of the given bytes.
+//
+// Any of the operations may throw exceptions on error.
+template <typename T>
+concept ByteStream = requires (T& stream, std::span<char> buffer,
+                               std::span<const char> bytes, std::size_t n) {
+  { stream.Read(buffer) } -> AwaitableOf<std::span<char>>;
+  { stream.ReadChunk(buffer) } -> AwaitableOf<std::span<char>>;
+  { stream.Receive(n) } -> AwaitableOf<std::span<const std::string_view>>;
+  stream.Consume(n);
+  { stream.Write(bytes) } -> AwaitableOf<void>;
+};
+
+// A type-erased reference to a ByteStream. This allows code which is compiled
+// separately (such as the solutions) to work with any kind of stream. Each
+// operation forwards the underlying stream's awaitable in an `AnyAwaitable`,
+// so going through a `Stream` costs an indirect call but no allocation.
+class Stream {
+ public:
+  template <ByteStream T>
+  requires (!std::same_as<T, Stream>)
+  explicit Stream(T& stream) {
+    data_ = &stream;
+    read_ = [](void* data, std::span<char> buffer) {
+      return AnyAwaitable<std::span<char>>(
+          [&] { return static_cast<T*>(data)->Read(buffer); });
+    };
+    read_chunk_ = [](void* data, std::span<char> buffer) {
+      return AnyAwaitable<std::span<char>>(
+          [&] { return static_cast<T*>(data)->ReadChunk(buffer); });
+    };
+    receive_ = [](void* data, std::size_t min_bytes) {
+      return AnyAwaitable<std::span<const std::string_view>>(
+          [&] { return static_cast<T*>(data)->Receive(min_bytes); });
+    };
+    consume_ = [](void* data, std::size_t n) {
+      static_cast<T*>(data)->Consume(n);
+    };
+    write_ = [](void* data, std::span<const char> bytes) {
+      return AnyAwaitable<void>(
+          [&] { return static_cast<T*>(data)->Write(bytes); });
+    };
+  }
+
+  AnyAwaitable<std::span<char>> Read(std::span<char> buffer) {
+    return read_(data_, buffer);
+  }
+
+  AnyAwaitable<std::span<char>> ReadChunk(std::span<char> buffer) {
+    return read_chunk_(data_, buffer);
+  }
+
+  AnyAwaitable<std::span<const std::string_view>> Receive(
+      std::size_t min_bytes) {
+    return receive_(data_, min_bytes);
+  }
+
+  void Consume(std::size_t n) { consume_(data_, n); }
+
+  AnyAwaitable<void> Write(std::span<const char> bytes) {
+    return write_(data_, bytes);
+  }
+
+ private:
+  void* data_;
+  AnyAwaitable<std::span<char>> (*read_)(void* data, std::span<char> buffer);
+  AnyAwaitable<std::span<char>> (*read_chunk_)(void* data,
+                                               std::span<char> buffer);
+  AnyAwaitable<std::span<const std::string_view>> (*receive_)(
+      void* data, std::size_t min_bytes);
+  void (*consume_)(void* data, std::size_t n);
+  AnyAwaitable<void> (*write_)(void* data, std::span<const char> bytes);
+};
+
+static_assert(ByteStream<Stream>);
+
+// An awaitable which completes immediately with the given value.
+template <typename T>
+class [[nodiscard]] Ready {
+ public:
+  explicit Ready(T value) : value_(std::move(value)) {}
+
+  bool await_ready() const noexcept { return true; }
+  void await_suspend(std::coroutine_handle<>) noexcept {}
+  T await_resume() { return std::move(value_); }
+
+ private:
+  T value_;
+};
+
+// A ByteStream which reads from an in-memory buffer and collects everything
+// that is written to it in a string. Every operation completes synchronously.
+class MemoryStream {
+ public:
+  explicit MemoryStream(std::string_view input) : input_(input) {}
+
+  Ready<std::span<char>> Read(std::span<char> buffer) {
+    const std::size_t n = std::min(buffer.size(), input_.size());
+    std::ranges::copy(input_.substr(0, n), buffer.begin());
+    input_.remove_prefix(n);
+    return Ready(buffer.first(n));
+  }
+
+  // The whole input is available immediately, so this is the same as `Read`.
+  Ready<std::span<char>> ReadChunk(std::span<char> buffer) {
+    return Read(buffer);
+  }
+
+  // The input is already a single contiguous segment, so it is returned as-is.
+  Ready<std::span<const std::string_view>> Receive(std::size_t) {
+    const std::size_t n = input_.empty() ? 0 : 1;
+    return Ready(std::span<const std::string_view>(&input_, n));
+  }
+
+  void Consume(std::size_t n) { input_.remove_prefix(n); }
+
+  std::suspend_never Write(std::span<const char> bytes) {
+    output_.append(bytes.begin(), bytes.end());
+    return {};
+  }
+
+  // Everything that has been written to the stream so far.
+  std::string_view output() const { return output_; }
+
+ private:
+  std::string_view input_;
+  std::string output_;
+};
+
+static_assert(ByteStream<MemoryStream>);
+
+// A ByteStream which ends after the next `size` bytes of another stream, so
+// that a connection can carry several inputs one after another. Writes go
+// straight to the underlying stream. Neither threadsafe nor reentrant.
+template <ByteStream T>
+class LimitedStream {
+ public:
+  LimitedStream(T& stream, std::size_t size)
+      : stream_(stream), remaining_(size) {}
+
+  // Not copyable.
+  LimitedStream(const LimitedStream&) = delete;
+  LimitedStream& operator=(const LimitedStream&) = delete;
+
+  Task<std::span<char>> Read(std::span<char> buffer) {
+    if (remaining_ == 0) co_return buffer.first(0);
+    const std::span<char> result = co_await stream_.Read(
+        buffer.first(std::min(buffer.size(), remaining_)));
+    remaining_ -= result.size();
+    co_return result;
+  }
+
+  Task<std::span<char>> ReadChunk(std::span<char> buffer) {
+    if (remaining_ == 0) co_return buffer.first(0);
+    const std::span<char> result = co_await stream_.ReadChunk(
+        buffer.first(std::min(buffer.size(), remaining_)));
+    remaining_ -= result.size();
+    co_return result;
+  }
+
+  // The underlying stream may already have received bytes beyond the limit,
+  // so the segments are truncated to hide them.
+  Task<std::span<const std::string_view>> Receive(std::size_t min_bytes) {
+    segments_.clear();
+    if (remaining_ == 0) co_return segments_;
+    std::size_t size = 0;
+    for (std::string_view segment :
+         co_await stream_.Receive(std::min(min_bytes, remaining_))) {
+      if (size == remaining_) break;
+      segment = segment.substr(0, remaining_ - size);
+      segments_.push_back(segment);
+      size += segment.size();
+    }
+    co_return segments_;
+  }
+
+  void Consume(std::size_t n) {
+    assert(n <= remaining_);
+    stream_.Consume(n);
+    remaining_ -= n;
+  }
+
+  auto Write(std::span<const char> bytes) { return stream_.Write(bytes); }
+
+  // Reads and discards whatever is left of the input, such as when a solution
+  // fails before reading all of it. Throws if the underlying stream ends first.
+  Task<void> Skip() {
+    char buffer[256];
+    while (remaining_ > 0) {
+      const std::span<char> chunk = co_await ReadChunk(buffer);
+      if (chunk.empty()) throw std::runtime_error("input ended early");
+    }
+  }
+
+  // The number of bytes which have not yet been read or consumed.
+  std::size_t remaining() const { return remaining_; }
+
+ private:
+  T& stream_;
+  std::size_t remaining_;
+  std::vector<std::string_view> segments_;
+};
+
+static_assert(ByteStream<LimitedStream<MemoryStream>>);
+
+// A ByteStream which hashes every byte that is read or consumed from another
+// stream, as it arrives. Writes go straight to the underlying stream. Neither
+// threadsafe nor reentrant.
+template <ByteStream T>
+class HashingStream {
+ public:
+  explicit HashingStream(T& stream) : stream_(stream) {}
+
+  // Not copyable.
+  HashingStream(const HashingStream&) = delete;
+  HashingStream& operator=(const HashingStream&) = delete;
+
+  Task<std::span<char>> Read(std::span<char> buffer) {
+    const std::span<char> result = co_await stream_.Read(buffer);
+    hash_.Update(result);
+    co_return result;
+  }
+
+  Task<std::span<char>> ReadChunk(std::span<char> buffer) {
+    const std::span<char> result = co_await stream_.ReadChunk(buffer);
+    hash_.Update(result);
+    co_return result;
+  }
+
+  // Received bytes are only hashed once they are consumed, since they are
+  // received again by the next call if they are not.
+  Task<std::span<const std::string_view>> Receive(std::size_t min_bytes) {
+    received_ = co_await stream_.Receive(min_bytes);
+    co_return received_;
+  }
+
+  void Consume(std::size_t n) {
+    std::size_t unhashed = n;
+    for (std::string_view segment : received_) {
+      if (unhashed == 0) break;
+      segment = segment.substr(0, unhashed);
+      hash_.Update(segment);
+      unhashed -= segment.size();
+    }
+    received_ = {};
+    stream_.Consume(n);
+  }
+
+  auto Write(std::span<const char> bytes) { return stream_.Write(bytes); }
+
+  // The hash of every byte which has been read or consumed so far.
+  std::uint64_t hash() const { return hash_.value(); }
+
+ private:
+  T& stream_;
+  std::span<const std::string_view> received_;
+  InputHash hash_;
+};
+
+static_assert(ByteStream<HashingStream<MemoryStream>>);
+
+// Reads and discards the rest of the stream.
+template <ByteStream T>
+Task<void> Discard(T& stream) {
+  char buffer[256];
+  while (true) {
+    const std::span<char> chunk = co_await stream.ReadChunk(buffer);
+    if (chunk.empty()) co_return;
+  }
+}
+
+}  // namespace aoc2024
+
+#endif  // AOC2024_STREAM_HPP_
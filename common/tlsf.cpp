@@ -0,0 +1,200 @@
+#include "tlsf.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <stdexcept>
+
+namespace aoc2024 {
+
+struct Tlsf::Block {
+  std::byte* bytes() { return reinterpret_cast<std::byte*>(this); }
+
+  std::size_t size() const { return size_and_free & ~std::size_t(1); }
+  bool free() const { return size_and_free & 1; }
+  void set(std::size_t size, bool free) { size_and_free = size | free; }
+
+  Block* next() { return reinterpret_cast<Block*>(bytes() + size()); }
+
+  // The block physically before this one, or `nullptr` for the first block.
+  Block* previous;
+  // The size of the block in bytes, including this header. Sizes are always
+  // multiples of `kAlignment`, so the low bit is set if the block is free.
+  std::size_t size_and_free;
+  // Links to the other blocks in the same free list. These are only present
+  // while the block is free: otherwise, they are part of the allocation.
+  Block* next_free;
+  Block* previous_free;
+};
+
+namespace {
+
+constexpr std::size_t kHeaderSize = 2 * sizeof(void*);
+static_assert(kHeaderSize == Tlsf::kAlignment);
+static_assert(__STDCPP_DEFAULT_NEW_ALIGNMENT__ <= Tlsf::kAlignment);
+
+}  // namespace
+
+Tlsf::Tlsf(std::span<std::byte> pool) {
+  static_assert(sizeof(Block) == 2 * kHeaderSize);
+  const auto address = reinterpret_cast<std::uintptr_t>(pool.data());
+  const std::size_t padding = -address & (kAlignment - 1);
+  if (pool.size() < padding + sizeof(Block) + kHeaderSize) {
+    throw std::runtime_error("pool is too small");
+  }
+  // The pool is one big free block followed by an empty block which is never
+  // free, so that the last real block always has a next block to look at.
+  const std::size_t size =
+      (pool.size() - padding - kHeaderSize) & ~(kAlignment - 1);
+  auto* block = reinterpret_cast<Block*>(pool.data() + padding);
+  block->previous = nullptr;
+  block->set(size, false);
+  Block* end = block->next();
+  end->previous = block;
+  end->set(0, false);
+  if (ClassOf(size).first >= kNumClasses) {
+    throw std::runtime_error("pool is too large");
+  }
+  capacity_ = size;
+  Insert(block);
+}
+
+void* Tlsf::Allocate(std::size_t size) {
+  if (size > capacity_) return nullptr;
+  const std::size_t needed = std::max(
+      sizeof(Block), (kHeaderSize + size + kAlignment - 1) & ~(kAlignment - 1));
+  Block* block = FindFree(SearchClassOf(needed));
+  if (!block) return nullptr;
+  Remove(block);
+  Split(block, needed);
+  in_use_ += block->size();
+  peak_ = std::max(peak_, in_use_);
+  num_allocations_++;
+  return block->bytes() + kHeaderSize;
+}
+
+void Tlsf::Free(void* p) {
+  if (!p) return;
+  auto* block = reinterpret_cast<Block*>(static_cast<std::byte*>(p) -
+                                         kHeaderSize);
+  assert(!block->free());
+  in_use_ -= block->size();
+  if (Block* next = block->next(); next->free()) {
+    Remove(next);
+    MergeNext(block);
+  }
+  if (Block* previous = block->previous; previous && previous->free()) {
+    Remove(previous);
+    MergeNext(previous);
+    block = previous;
+  }
+  Insert(block);
+}
+
+std::size_t Tlsf::BlockSize(const void* p) {
+  return reinterpret_cast<const Block*>(static_cast<const std::byte*>(p) -
+                                        kHeaderSize)
+      ->size();
+}
+
+std::size_t Tlsf::LargestFreeBlock() const {
+  if (!first_map_) return 0;
+  const int first = std::bit_width(first_map_) - 1;
+  const int second = std::bit_width(second_maps_[first]) - 1;
+  std::size_t result = 0;
+  for (Block* block = free_lists_[first][second]; block;
+       block = block->next_free) {
+    result = std::max(result, block->size());
+  }
+  return result;
+}
+
+// Sizes below `kLinearLimit` all share the first class, with one subclass for
+// each multiple of `kAlignment`. Above that, each power of two has a class.
+Tlsf::SizeClass Tlsf::ClassOf(std::size_t size) {
+  constexpr std::size_t kLinearLimit = kAlignment << kSubclassBits;
+  constexpr int kLinearBits = std::countr_zero(kLinearLimit);
+  if (size < kLinearLimit) {
+    return SizeClass{.first = 0, .second = int(size / kAlignment)};
+  }
+  const int log = std::bit_width(size) - 1;
+  return SizeClass{
+      .first = log - kLinearBits + 1,
+      .second = int(size >> (log - kSubclassBits)) - kNumSubclasses,
+  };
+}
+
+Tlsf::SizeClass Tlsf::SearchClassOf(std::size_t size) {
+  constexpr std::size_t kLinearLimit = kAlignment << kSubclassBits;
+  if (size >= kLinearLimit) {
+    // Round up to the next subclass boundary, so that any block in the class
+    // is large enough.
+    const int log = std::bit_width(size) - 1;
+    size += (std::size_t(1) << (log - kSubclassBits)) - 1;
+  }
+  return ClassOf(size);
+}
+
+Tlsf::Block* Tlsf::FindFree(SizeClass size_class) const {
+  if (size_class.first >= kNumClasses) return nullptr;
+  int first = size_class.first;
+  std::uint32_t seconds = second_maps_[first] & (~0u << size_class.second);
+  if (!seconds) {
+    // Any block in a larger first level class will do.
+    const std::uint32_t firsts =
+        first_map_ & ~std::uint32_t((std::uint64_t(2) << first) - 1);
+    if (!firsts) return nullptr;
+    first = std::countr_zero(firsts);
+    seconds = second_maps_[first];
+  }
+  return free_lists_[first][std::countr_zero(seconds)];
+}
+
+void Tlsf::Insert(Block* block) {
+  const SizeClass size_class = ClassOf(block->size());
+  Block*& head = free_lists_[size_class.first][size_class.second];
+  block->set(block->size(), true);
+  block->next_free = head;
+  block->previous_free = nullptr;
+  if (head) head->previous_free = block;
+  head = block;
+  first_map_ |= 1u << size_class.first;
+  second_maps_[size_class.first] |= 1u << size_class.second;
+}
+
+void Tlsf::Remove(Block* block) {
+  const SizeClass size_class = ClassOf(block->size());
+  Block*& head = free_lists_[size_class.first][size_class.second];
+  block->set(block->size(), false);
+  if (block->next_free) block->next_free->previous_free = block->previous_free;
+  if (block->previous_free) {
+    block->previous_free->next_free = block->next_free;
+  } else {
+    head = block->next_free;
+  }
+  if (!head) {
+    std::uint32_t& seconds = second_maps_[size_class.first];
+    seconds &= ~(1u << size_class.second);
+    if (!seconds) first_map_ &= ~(1u << size_class.first);
+  }
+}
+
+void Tlsf::Split(Block* block, std::size_t size) {
+  const std::size_t rest = block->size() - size;
+  if (rest < sizeof(Block)) return;
+  block->set(size, block->free());
+  Block* tail = block->next();
+  tail->previous = block;
+  tail->set(rest, false);
+  tail->next()->previous = tail;
+  Insert(tail);
+}
+
+void Tlsf::MergeNext(Block* block) {
+  Block* next = block->next();
+  assert(!next->free());
+  block->set(block->size() + next->size(), block->free());
+  block->next()->previous = block;
+}
+
+}  // namespace aoc2024
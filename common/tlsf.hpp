@@ -0,0 +1,110 @@
+#ifndef AOC2024_TLSF_HPP_
+#define AOC2024_TLSF_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace aoc2024 {
+
+// A two-level segregated fit allocator over a fixed pool of memory, after
+// "TLSF: a New Dynamic Memory Allocator for Real-Time Systems" (Masmano et al,
+// 2004). Allocating and freeing both take constant time, and since a request
+// is always served from the smallest size class which is certain to fit it,
+// fragmentation stays low over a long-running session.
+//
+// Free blocks are kept in a list per size class. The first level splits sizes
+// by powers of two and the second level splits each power of two into
+// `kNumSubclasses` linear steps. A bitmap for each level records which lists
+// are non-empty, so the right list is found with a couple of bit scans. Every
+// block starts with a header which links it to the block physically before it,
+// so neighbouring free blocks can be merged as soon as they appear.
+//
+// Neither threadsafe nor reentrant.
+class Tlsf {
+ public:
+  // The alignment of every allocation.
+  static constexpr std::size_t kAlignment = 2 * sizeof(void*);
+
+  // Manages the memory of `pool`, which must outlive the allocator.
+  explicit Tlsf(std::span<std::byte> pool);
+
+  // Not copyable.
+  Tlsf(const Tlsf&) = delete;
+  Tlsf& operator=(const Tlsf&) = delete;
+
+  // Returns at least `size` bytes aligned to `kAlignment`, or `nullptr` if no
+  // free block is large enough.
+  void* Allocate(std::size_t size);
+
+  // Returns memory from `Allocate()` to the pool. `p` may be `nullptr`.
+  void Free(void* p);
+
+  // The number of bytes of the pool taken by the allocation at `p`, including
+  // its header and padding.
+  static std::size_t BlockSize(const void* p);
+
+  // The number of bytes which are available for blocks, excluding the pool's
+  // own bookkeeping.
+  std::size_t capacity() const { return capacity_; }
+
+  // The number of bytes which are taken by allocations, including headers.
+  std::size_t in_use() const { return in_use_; }
+
+  // The most bytes that have ever been in use.
+  std::size_t peak() const { return peak_; }
+
+  // The total number of successful calls to `Allocate()`.
+  std::uint64_t num_allocations() const { return num_allocations_; }
+
+  // The size of the largest free block, including its header. Any allocation
+  // which needs a larger block will fail, however much memory is free in
+  // total. The free blocks of the largest size class are walked, so this is
+  // not constant time.
+  std::size_t LargestFreeBlock() const;
+
+ private:
+  static constexpr int kSubclassBits = 4;
+  static constexpr int kNumSubclasses = 1 << kSubclassBits;
+  static constexpr int kNumClasses = 32;
+
+  struct Block;
+
+  // Identifies the free list for a block size.
+  struct SizeClass {
+    int first, second;
+  };
+
+  // The class whose blocks are at least as large as `size` and no larger than
+  // the next class, which is where a free block of that size belongs.
+  static SizeClass ClassOf(std::size_t size);
+
+  // The smallest class whose blocks are all at least `size`, which is where
+  // a search for a block of that size starts.
+  static SizeClass SearchClassOf(std::size_t size);
+
+  // The first non-empty list from `size_class` upwards, or `nullptr`.
+  Block* FindFree(SizeClass size_class) const;
+
+  void Insert(Block* block);
+  void Remove(Block* block);
+
+  // Splits the end of `block` off into a new free block so that `block` has
+  // `size` bytes, if the rest is large enough to be a block of its own.
+  void Split(Block* block, std::size_t size);
+
+  // Merges `block` with the block after it, which must be free.
+  void MergeNext(Block* block);
+
+  std::uint32_t first_map_ = 0;
+  std::uint32_t second_maps_[kNumClasses] = {};
+  Block* free_lists_[kNumClasses][kNumSubclasses] = {};
+  std::size_t capacity_ = 0;
+  std::size_t in_use_ = 0;
+  std::size_t peak_ = 0;
+  std::uint64_t num_allocations_ = 0;
+};
+
+}  // namespace aoc2024
+
+#endif  // AOC2024_TLSF_HPP_
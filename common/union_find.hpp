@@ -0,0 +1,81 @@
+#ifndef AOC2024_UNION_FIND_HPP_
+#define AOC2024_UNION_FIND_HPP_
+
+#include <cassert>
+#include <concepts>
+#include <cstddef>
+#include <limits>
+#include <utility>
+
+namespace aoc2024 {
+
+// Data which is tracked for each set of a `UnionFind`, such as its size. When
+// two sets are merged, `a.Merge(b)` combines the data for `b` into `a`.
+template <typename T>
+concept UnionFindPayload = std::default_initializable<T> &&
+                           requires (T& a, const T& b) { a.Merge(b); };
+
+// A disjoint-set forest over the elements `[0, size)` for some `size` up to
+// `kCapacity`, where each set carries a `Payload`.
+//
+// The parents and payloads are stored in separate arrays, so finding a root
+// only touches the (small) parents. A root has no parent, so its entry holds
+// the rank of the set instead, as a negative number. Sets are merged by rank
+// and paths are halved as they are walked, which keeps trees shallow without
+// a second pass to compress them.
+template <std::signed_integral Index, UnionFindPayload Payload,
+          std::size_t kCapacity>
+class UnionFind {
+ public:
+  static_assert(kCapacity <= std::size_t(std::numeric_limits<Index>::max()));
+
+  // Makes each of the first `size` elements a set of its own, with `initial`
+  // as its payload.
+  void Reset(std::size_t size, const Payload& initial = {}) {
+    assert(size <= kCapacity);
+    for (std::size_t i = 0; i < size; i++) {
+      parents_[i] = -1;
+      payloads_[i] = initial;
+    }
+  }
+
+  bool IsRoot(Index i) const { return parents_[i] < 0; }
+
+  // The payload of `i`. For a root, this covers the whole set. Payloads of
+  // other elements are left as they were when their set was merged.
+  Payload& payload(Index i) { return payloads_[i]; }
+  const Payload& payload(Index i) const { return payloads_[i]; }
+
+  // Returns the root of the set containing `i`.
+  Index Find(Index i) {
+    while (!IsRoot(i)) {
+      const Index parent = parents_[i];
+      if (IsRoot(parent)) return parent;
+      // Skip over the parent, halving the length of the path.
+      i = parents_[i] = parents_[parent];
+    }
+    return i;
+  }
+
+  // Merges the sets containing `a` and `b` and returns the root of the result.
+  Index Merge(Index a, Index b) {
+    a = Find(a);
+    b = Find(b);
+    if (a == b) return a;
+    // Ranks are stored negated, so the larger rank is the smaller value.
+    if (parents_[a] > parents_[b]) std::swap(a, b);
+    if (parents_[a] == parents_[b]) parents_[a]--;
+    parents_[b] = a;
+    payloads_[a].Merge(payloads_[b]);
+    return a;
+  }
+
+ private:
+  // For a root, `-1 - rank`. Otherwise, the index of the parent.
+  Index parents_[kCapacity];
+  Payload payloads_[kCapacity];
+};
+
+}  // namespace aoc2024
+
+#endif  // AOC2024_UNION_FIND_HPP_
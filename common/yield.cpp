@@ -0,0 +1,17 @@
+#include "yield.hpp"
+
+namespace aoc2024 {
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Starts out expired, so the first call to `MaybeYield()` may yield early.
+Clock::time_point time_slice_end;
+
+}  // namespace
+
+bool TimeSliceExpired() { return Clock::now() >= time_slice_end; }
+
+void StartTimeSlice() { time_slice_end = Clock::now() + kTimeSlice; }
+
+}  // namespace aoc2024
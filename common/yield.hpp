@@ -0,0 +1,59 @@
+#ifndef AOC2024_YIELD_HPP_
+#define AOC2024_YIELD_HPP_
+
+#include "schedule.hpp"
+
+#include <chrono>
+#include <coroutine>
+
+namespace aoc2024 {
+
+// How long a solution may keep the event loop to itself before `MaybeYield()`
+// lets other work run.
+inline constexpr std::chrono::milliseconds kTimeSlice(5);
+
+// Whether `kTimeSlice` has passed since the current time slice started.
+bool TimeSliceExpired();
+
+// Starts a new time slice. Called whenever a coroutine resumes after yielding.
+void StartTimeSlice();
+
+// Lets the event loop run other work if the current time slice is used up:
+//
+//     for (...) {
+//       co_await MaybeYield();
+//       ...
+//     }
+//
+// Solutions run on the event loop, so while one is busy, nothing else
+// progresses: not other requests, and on the Pico, not even lwIP, so other
+// clients' connections stall. Heavy solutions should call this from their outer
+// loops. It only reads the clock unless the slice is used up, in which case the
+// coroutine is rescheduled behind everything else which is waiting to run.
+class [[nodiscard]] YieldAwaitable {
+ public:
+  bool await_ready() const { return !TimeSliceExpired(); }
+
+  void await_suspend(std::coroutine_handle<> handle) {
+    handle_ = handle;
+    task_.data = this;
+    task_.func = [](void* data) {
+      auto& self = *static_cast<YieldAwaitable*>(data);
+      StartTimeSlice();
+      self.handle_.resume();
+    };
+    task_.Schedule();
+  }
+
+  void await_resume() {}
+
+ private:
+  std::coroutine_handle<> handle_;
+  BackgroundTask task_;
+};
+
+inline YieldAwaitable MaybeYield() { return {}; }
+
+}  // namespace aoc2024
+
+#endif  // AOC2024_YIELD_HPP_
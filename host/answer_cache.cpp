@@ -0,0 +1,27 @@
+#include "../common/answer_cache.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+
+namespace aoc2024 {
+namespace {
+
+// Relative to the directory which the server is run from.
+constexpr char kPath[] = "answer_cache.bin";
+
+}  // namespace
+
+void LoadAnswerCache(std::span<char, AnswerCache::kCapacity> data) {
+  std::ranges::fill(data, 0);
+  std::ifstream file(kPath, std::ios::binary);
+  file.read(data.data(), data.size());
+}
+
+void StoreAnswerCache(std::span<const char, AnswerCache::kCapacity> data) {
+  std::ofstream file(kPath, std::ios::binary | std::ios::trunc);
+  file.write(data.data(), data.size());
+  if (!file) throw std::runtime_error("cannot write answer cache");
+}
+
+}  // namespace aoc2024
@@ -0,0 +1,317 @@
+// Benchmarks the solutions against the puzzle inputs on the host.
+//
+//     aoc_bench [--runs=N] [--puzzles=DIR] [--baseline=FILE] [day...]
+//
+// Each day with an input in `puzzles/dayNN.input` is solved N times, feeding
+// the input through a `MemoryStream` so that no time is spent in the network
+// stack. The output has one line per day with the min/median/p99 wall time,
+// followed by the median time of each phase (as recorded by the solution's
+// events), the size of the solution's coroutine frame, the most stack and heap
+// that any run used (see `MemoryWatermark`), and the most heap allocations that
+// any run made. Saving the output to a file and passing it as `--baseline` on a
+// later run adds a column with the relative change in median time, which makes
+// regressions easy to spot.
+
+#include "../common/api.hpp"
+#include "../common/coro.hpp"
+#include "../common/frame_arena.hpp"
+#include "../common/memory.hpp"
+#include "../common/parallel.hpp"
+#include "../common/request_arena.hpp"
+#include "../common/schedule.hpp"
+#include "../common/stream.hpp"
+#include "../server/serve.hpp"
+#include "../server/solve.hpp"
+#include "event_loop.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fcntl.h>
+#include <format>
+#include <fstream>
+#include <map>
+#include <optional>
+#include <print>
+#include <span>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+namespace aoc2024 {
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using Duration = std::chrono::microseconds;
+
+struct Options {
+  int runs = 20;
+  std::string puzzles = "puzzles";
+  std::string baseline;
+  std::vector<int> days;
+};
+
+struct Sample {
+  Duration total;
+  // The size of the solution's coroutine frame, in bytes.
+  std::size_t frame_size;
+  // The peak stack and heap usage of the run.
+  MemoryUsage memory;
+  // `events[i]` is the time of `Event(i)` relative to the start of the
+  // request, if the solution recorded it.
+  std::optional<Duration> events[4];
+};
+
+// Solutions print their progress to stdout, which would dominate both the
+// timings and the output of the benchmark. While one of these is alive, stdout
+// is redirected to /dev/null.
+class SilenceStdout {
+ public:
+  SilenceStdout() {
+    std::fflush(stdout);
+    saved_ = dup(STDOUT_FILENO);
+    const int null = open("/dev/null", O_WRONLY | O_CLOEXEC);
+    dup2(null, STDOUT_FILENO);
+    close(null);
+  }
+
+  ~SilenceStdout() {
+    std::fflush(stdout);
+    dup2(saved_, STDOUT_FILENO);
+    close(saved_);
+  }
+
+  // Not copyable.
+  SilenceStdout(const SilenceStdout&) = delete;
+  SilenceStdout& operator=(const SilenceStdout&) = delete;
+
+ private:
+  int saved_;
+};
+
+Task<void> SolveCatching(int day, Stream& stream, Response& response,
+                         FrameArena& arena, std::string& error) {
+  try {
+    co_await Solve(day, stream, response, arena);
+  } catch (const std::exception& e) {
+    error = e.what();
+  }
+}
+
+// Large enough for the frame of any of the solutions.
+constexpr std::size_t kFrameArenaSize = 256 * 1024;
+
+// The same as the server's default. Like the server's, the scratch arena takes
+// everything from the heap, so scratch memory shows up as heap usage.
+constexpr std::size_t kRequestBlockSize = ServeOptions().request_block_size;
+
+Sample Run(int day, std::string_view input) {
+  alignas(__STDCPP_DEFAULT_NEW_ALIGNMENT__) static std::byte
+      frames[kFrameArenaSize];
+  FrameArena arena(frames);
+  // Destroyed after the task, which frees anything the solution allocated.
+  RequestArena scratch(kRequestBlockSize);
+  MemoryStream memory(input);
+  Stream stream(memory);
+  bool solved = false;
+  std::string error;
+
+  char response_buffer[kResponseBufferSize - ResponseHeader::kNumBytes];
+  const Clock::time_point start = Clock::now();
+  Response response(response_buffer, scratch);
+  const MemoryWatermark watermark;
+  Task<void> solve = SolveCatching(day, stream, response, arena, error);
+  solve.Start([&] { solved = true; });
+  // Reads never block, but solutions may still hand work to the scheduler (such
+  // as when they yield). There is no I/O to wait for, so never wait: the solve
+  // may finish during the first pass over the background tasks, and waiting
+  // after that would block forever.
+  while (!solved) RunOnce(0);
+  const Clock::time_point end = Clock::now();
+  const MemoryUsage usage = watermark.Measure();
+  if (!error.empty()) throw std::runtime_error(error);
+
+  Sample sample = {
+      .total = std::chrono::duration_cast<Duration>(end - start),
+      .frame_size = arena.last_frame_size(),
+      .memory = usage,
+      .events = {},
+  };
+  std::span<const char> bytes = response.bytes();
+  while (!bytes.empty()) {
+    const ResponsePacket packet = ResponsePacket::Decode(bytes);
+    if (packet.type != ResponsePacketType::kEvent) continue;
+    if (packet.event == Event::kSpan || packet.event == Event::kMemory) {
+      continue;
+    }
+    sample.events[int(packet.event)] = packet.time;
+  }
+  return sample;
+}
+
+Duration Percentile(std::vector<Duration> values, int percent) {
+  assert(!values.empty());
+  std::ranges::sort(values);
+  const int n = values.size();
+  const int i = std::min(n - 1, (n * percent + 99) / 100 - 1);
+  return values[std::max(i, 0)];
+}
+
+// Returns the duration of the phase which ends with `event`, measured from the
+// latest earlier event that was recorded (or the start of the request).
+std::optional<Duration> Phase(const Sample& sample, Event event) {
+  const int end = int(event);
+  if (!sample.events[end]) return std::nullopt;
+  for (int start = end - 1; start > int(Event::kRequestParsed); start--) {
+    if (sample.events[start]) {
+      return *sample.events[end] - *sample.events[start];
+    }
+  }
+  return *sample.events[end];
+}
+
+std::string FormatPhase(std::span<const Sample> samples, Event event) {
+  std::vector<Duration> values;
+  for (const Sample& sample : samples) {
+    if (auto phase = Phase(sample, event)) values.push_back(*phase);
+  }
+  if (values.empty()) return "-";
+  return std::to_string(Percentile(std::move(values), 50).count());
+}
+
+std::optional<std::string> ReadFile(const std::string& path) {
+  std::ifstream file(path);
+  if (!file) return std::nullopt;
+  std::ostringstream contents;
+  contents << file.rdbuf();
+  return std::move(contents).str();
+}
+
+// Reads the median time for each day from the output of a previous run.
+std::map<int, Duration> ReadBaseline(const std::string& path) {
+  std::map<int, Duration> result;
+  std::ifstream file(path);
+  if (!file) throw std::runtime_error("cannot read baseline " + path);
+  std::string line;
+  while (std::getline(file, line)) {
+    std::istringstream fields(line);
+    int day, runs;
+    std::int64_t min, median;
+    if (fields >> day >> runs >> min >> median) {
+      result[day] = Duration(median);
+    }
+  }
+  return result;
+}
+
+bool ParseInt(std::string_view text, int& value) {
+  auto [end, error] =
+      std::from_chars(text.data(), text.data() + text.size(), value);
+  return error == std::errc() && end == text.data() + text.size();
+}
+
+Options ParseOptions(int argc, char* argv[]) {
+  Options options;
+  for (int i = 1; i < argc; i++) {
+    const std::string_view arg = argv[i];
+    int day;
+    if (arg.starts_with("--runs=")) {
+      if (!ParseInt(arg.substr(7), options.runs) || options.runs < 1) {
+        throw std::runtime_error("bad --runs");
+      }
+    } else if (arg.starts_with("--puzzles=")) {
+      options.puzzles = arg.substr(10);
+    } else if (arg.starts_with("--baseline=")) {
+      options.baseline = arg.substr(11);
+    } else if (ParseInt(arg, day) && 1 <= day && day <= 25) {
+      options.days.push_back(day);
+    } else {
+      throw std::runtime_error("bad argument: " + std::string(arg));
+    }
+  }
+  if (options.days.empty()) {
+    for (int day = 1; day <= 25; day++) options.days.push_back(day);
+  }
+  return options;
+}
+
+void Benchmark(int argc, char* argv[]) {
+  const Options options = ParseOptions(argc, argv);
+  const std::map<int, Duration> baseline =
+      options.baseline.empty() ? std::map<int, Duration>()
+                               : ReadBaseline(options.baseline);
+  if (!SchedulerInit()) throw std::runtime_error("SchedulerInit failed");
+  ExecutorInit();
+
+  std::println(
+      "{:>3} {:>5} {:>10} {:>10} {:>10} {:>10} {:>10} {:>10} {:>8} {:>8} "
+      "{:>9} {:>7}{}",
+      "day", "runs", "min_us", "median_us", "p99_us", "parse_us", "part1_us",
+      "part2_us", "frame_b", "stack_b", "heap_b", "allocs",
+      baseline.empty() ? "" : "   vs_base");
+  for (int day : options.days) {
+    const std::string path =
+        std::format("{}/day{:02}.input", options.puzzles, day);
+    const std::optional<std::string> input = ReadFile(path);
+    if (!input) continue;
+
+    std::vector<Sample> samples;
+    std::string error;
+    {
+      SilenceStdout silence;
+      try {
+        for (int i = 0; i < options.runs; i++) {
+          samples.push_back(Run(day, *input));
+        }
+      } catch (const std::exception& e) {
+        error = e.what();
+      }
+    }
+    if (!error.empty()) {
+      std::println("{:>3} failed: {}", day, error);
+      continue;
+    }
+
+    std::vector<Duration> totals;
+    std::size_t stack = 0, heap = 0, allocations = 0;
+    for (const Sample& sample : samples) {
+      totals.push_back(sample.total);
+      stack = std::max(stack, sample.memory.stack_used);
+      heap = std::max(heap, sample.memory.heap_used);
+      allocations = std::max(allocations, sample.memory.heap_allocations);
+    }
+    const Duration median = Percentile(totals, 50);
+    std::string comparison;
+    if (auto i = baseline.find(day); i != baseline.end()) {
+      const double change =
+          100.0 * (median.count() - i->second.count()) / i->second.count();
+      comparison = std::format(" {:>+9.1f}%", change);
+    }
+    std::println(
+        "{:>3} {:>5} {:>10} {:>10} {:>10} {:>10} {:>10} {:>10} {:>8} {:>8} "
+        "{:>9} {:>7}{}",
+        day, options.runs, Percentile(totals, 0).count(), median.count(),
+        Percentile(totals, 99).count(),
+        FormatPhase(samples, Event::kInputParsed),
+        FormatPhase(samples, Event::kPart1Done),
+        FormatPhase(samples, Event::kDone), samples.front().frame_size, stack,
+        heap, allocations, comparison);
+  }
+}
+
+}  // namespace
+}  // namespace aoc2024
+
+int main(int argc, char* argv[]) {
+  try {
+    aoc2024::Benchmark(argc, argv);
+  } catch (const std::exception& e) {
+    std::println(stderr, "{}", e.what());
+    return 1;
+  }
+}
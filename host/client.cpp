@@ -0,0 +1,295 @@
+// Sends puzzle inputs to a server (on the Pico or the host) and decodes the
+// responses.
+//
+//     aoc_client [--port=PORT] [--log=FILE] HOST DAY < INPUT
+//     aoc_client [--port=PORT] [--log=FILE] [--puzzles=DIR] HOST DAY...|all
+//
+// With a single day, the input is read from stdin. Otherwise, each day's input
+// is read from `DIR/dayNN.input` (`all` means every day which has one) and all
+// of the requests are sent up front on a single connection, so the server never
+// waits for the next one. The answers are printed to stdout, preceded by the
+// day when there are several. Debug
+// output, the timing of each phase of the request and its peak memory usage
+// are printed to stderr. With `--log`, the raw responses are also appended to a
+// response log for `aoc_trace`.
+
+#include "../common/api.hpp"
+#include "../common/hash.hpp"
+#include "response_log.hpp"
+
+#include <cerrno>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <fstream>
+#include <netdb.h>
+#include <optional>
+#include <print>
+#include <span>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <sys/socket.h>
+#include <system_error>
+#include <unistd.h>
+#include <vector>
+
+namespace aoc2024 {
+namespace {
+
+struct Options {
+  std::string host;
+  std::string port = std::to_string(0xA0C);
+  std::string log;
+  std::string puzzles;
+  std::vector<int> days;
+  // If set, days without an input are skipped rather than being an error.
+  bool all = false;
+};
+
+// A request which has been read but not yet sent.
+struct Request {
+  int day;
+  std::string input;
+};
+
+bool ParseInt(std::string_view text, int& value) {
+  auto [end, error] =
+      std::from_chars(text.data(), text.data() + text.size(), value);
+  return error == std::errc() && end == text.data() + text.size();
+}
+
+Options ParseOptions(int argc, char* argv[]) {
+  Options options;
+  std::vector<std::string_view> positional;
+  for (int i = 1; i < argc; i++) {
+    const std::string_view arg = argv[i];
+    if (arg.starts_with("--port=")) {
+      options.port = arg.substr(7);
+    } else if (arg.starts_with("--log=")) {
+      options.log = arg.substr(6);
+    } else if (arg.starts_with("--puzzles=")) {
+      options.puzzles = arg.substr(10);
+    } else if (arg.starts_with("--")) {
+      throw std::runtime_error("bad argument: " + std::string(arg));
+    } else {
+      positional.push_back(arg);
+    }
+  }
+  if (positional.size() < 2) {
+    throw std::runtime_error(
+        "Usage: aoc_client [--port=PORT] [--log=FILE] [--puzzles=DIR] HOST "
+        "DAY...|all");
+  }
+  options.host = positional[0];
+  for (std::string_view arg : std::span(positional).subspan(1)) {
+    int day;
+    if (arg == "all") {
+      for (int day = 1; day <= 25; day++) options.days.push_back(day);
+      options.all = true;
+    } else if (ParseInt(arg, day) && 1 <= day && day <= 25) {
+      options.days.push_back(day);
+    } else {
+      throw std::runtime_error("bad day: " + std::string(arg));
+    }
+  }
+  // A single day reads its input from stdin, as `solve.sh` does.
+  if ((options.all || options.days.size() > 1) && options.puzzles.empty()) {
+    options.puzzles = "puzzles";
+  }
+  return options;
+}
+
+// A connected socket which is closed on destruction.
+class Connection {
+ public:
+  Connection(const std::string& host, const std::string& port) {
+    addrinfo hints = {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* addresses;
+    const int error =
+        getaddrinfo(host.c_str(), port.c_str(), &hints, &addresses);
+    if (error != 0) throw std::runtime_error(host + ": " + gai_strerror(error));
+    for (addrinfo* a = addresses; a; a = a->ai_next) {
+      fd_ = socket(a->ai_family, a->ai_socktype | SOCK_CLOEXEC,
+                   a->ai_protocol);
+      if (fd_ == -1) continue;
+      if (connect(fd_, a->ai_addr, a->ai_addrlen) == 0) break;
+      close(fd_);
+      fd_ = -1;
+    }
+    freeaddrinfo(addresses);
+    if (fd_ == -1) {
+      throw std::system_error(errno, std::generic_category(), "connect");
+    }
+  }
+
+  ~Connection() { close(fd_); }
+
+  // Not copyable.
+  Connection(const Connection&) = delete;
+  Connection& operator=(const Connection&) = delete;
+
+  void Write(std::span<const char> bytes) {
+    while (!bytes.empty()) {
+      const ssize_t n = write(fd_, bytes.data(), bytes.size());
+      if (n == -1) {
+        if (errno == EINTR) continue;
+        throw std::system_error(errno, std::generic_category(), "write");
+      }
+      bytes = bytes.subspan(n);
+    }
+  }
+
+  // Signals the end of the input to the server.
+  void CloseWrite() {
+    if (shutdown(fd_, SHUT_WR) == -1) {
+      throw std::system_error(errno, std::generic_category(), "shutdown");
+    }
+  }
+
+  // Reads exactly `size` bytes, or fewer if the server closes the connection.
+  std::string Read(std::size_t size) {
+    std::string result(size, '\0');
+    std::size_t done = 0;
+    while (done < size) {
+      const ssize_t n = read(fd_, result.data() + done, size - done);
+      if (n == 0) break;
+      if (n == -1) {
+        if (errno == EINTR) continue;
+        throw std::system_error(errno, std::generic_category(), "read");
+      }
+      done += n;
+    }
+    result.resize(done);
+    return result;
+  }
+
+ private:
+  int fd_ = -1;
+};
+
+std::optional<std::string> ReadFile(const std::string& path) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) return std::nullopt;
+  std::ostringstream contents;
+  contents << file.rdbuf();
+  return std::move(contents).str();
+}
+
+std::string ReadStdin() {
+  std::string result;
+  char buffer[4096];
+  while (true) {
+    const ssize_t n = read(STDIN_FILENO, buffer, sizeof(buffer));
+    if (n == 0) return result;
+    if (n == -1) {
+      if (errno == EINTR) continue;
+      throw std::system_error(errno, std::generic_category(), "read stdin");
+    }
+    result.append(buffer, n);
+  }
+}
+
+std::vector<Request> ReadRequests(const Options& options) {
+  std::vector<Request> requests;
+  if (options.puzzles.empty()) {
+    requests.push_back({.day = options.days.front(), .input = ReadStdin()});
+    return requests;
+  }
+  for (int day : options.days) {
+    const std::string path =
+        std::format("{}/day{:02}.input", options.puzzles, day);
+    if (std::optional<std::string> input = ReadFile(path)) {
+      requests.push_back({.day = day, .input = std::move(*input)});
+    } else if (!options.all) {
+      throw std::runtime_error("cannot read " + path);
+    }
+  }
+  return requests;
+}
+
+void PrintResponse(std::span<const char> bytes) {
+  while (!bytes.empty()) {
+    const ResponsePacket packet = ResponsePacket::Decode(bytes);
+    switch (packet.type) {
+      case ResponsePacketType::kOutput:
+        std::print("{}", packet.text);
+        break;
+      case ResponsePacketType::kDebug:
+        std::println(stderr, "{}", packet.text);
+        break;
+      case ResponsePacketType::kEvent:
+        if (packet.event == Event::kSpan) {
+          std::println(stderr, "{:{}}{}: {}us (at {}us)", "", 2 * packet.depth,
+                       packet.label, packet.duration.count(),
+                       packet.time.count());
+        } else if (packet.event == Event::kMemory) {
+          std::println(stderr, "{}", FormatMemoryUsage(packet.memory));
+        } else {
+          std::println(stderr, "{}: {}us", EventName(packet.event),
+                       packet.time.count());
+        }
+        break;
+    }
+  }
+}
+
+void Run(int argc, char* argv[]) {
+  const Options options = ParseOptions(argc, argv);
+  const std::vector<Request> requests = ReadRequests(options);
+
+  // Every request is sent before any response is read. The server only holds
+  // on to one response while it solves the next request, so this can't
+  // deadlock: the responses wait in our receive buffer.
+  Connection connection(options.host, options.port);
+  for (const Request& request : requests) {
+    char header[RequestHeader::kNumBytes];
+    InputHash hash;
+    hash.Update(request.input);
+    RequestHeader{.day = std::int8_t(request.day),
+                  .input_size = std::uint32_t(request.input.size()),
+                  .input_hash = hash.value()}
+        .EncodeTo(header);
+    connection.Write(header);
+    connection.Write(request.input);
+  }
+  connection.CloseWrite();
+
+  for (const Request& request : requests) {
+    const std::string header = connection.Read(ResponseHeader::kNumBytes);
+    if (header.size() != ResponseHeader::kNumBytes) {
+      throw std::runtime_error(
+          std::format("connection closed before day {}", request.day));
+    }
+    const std::size_t size =
+        ResponseHeader::Decode(
+            std::span<const char, ResponseHeader::kNumBytes>(header))
+            .size;
+    const std::string response = connection.Read(size);
+    if (response.size() != size) {
+      throw std::runtime_error(
+          std::format("truncated response for day {}", request.day));
+    }
+    if (!options.log.empty()) {
+      AppendResponse(options.log, request.day, response);
+    }
+    if (requests.size() > 1) std::println("Day {}", request.day);
+    PrintResponse(response);
+  }
+}
+
+}  // namespace
+}  // namespace aoc2024
+
+int main(int argc, char* argv[]) {
+  try {
+    aoc2024::Run(argc, argv);
+  } catch (const std::exception& e) {
+    std::println(stderr, "{}", e.what());
+    return 1;
+  }
+}
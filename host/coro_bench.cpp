@@ -0,0 +1,112 @@
+// Measures the overhead of the coroutine machinery in common/coro.hpp.
+//
+//     coro_bench [--iterations=N]
+//
+// Each case starts a task N times and reports the mean time per `co_await` of
+// a `Task`. The frames are allocated from a `FrameArena` so that the heap does
+// not dominate the timings.
+
+#include "../common/coro.hpp"
+#include "../common/frame_arena.hpp"
+#include "../common/stream.hpp"
+
+#include <charconv>
+#include <chrono>
+#include <cstddef>
+#include <format>
+#include <print>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace aoc2024 {
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Prevents the compiler from optimising away the results.
+volatile int sink;
+
+Task<int> Leaf() { co_return 1; }
+
+// A chain of `depth` tasks, each awaiting the next, ending with a leaf.
+Task<int> Chain(int depth) {
+  if (depth == 0) co_return co_await Leaf();
+  co_return 1 + co_await Chain(depth - 1);
+}
+
+// Mirrors the input handling of days 10 and 11: the solution awaits a helper
+// task which reads the whole input from the stream.
+Task<std::span<char>> ReadInput(Stream& stream, std::span<char> buffer) {
+  co_return co_await stream.Read(buffer);
+}
+
+Task<int> ReadAndCount(Stream& stream) {
+  char buffer[64];
+  int total = 0;
+  for (int i = 0; i < 4; i++) {
+    total += (co_await ReadInput(stream, buffer)).size();
+  }
+  co_return total;
+}
+
+// Runs `make_task()` to completion `iterations` times and prints the mean time
+// for each of its `awaits` awaits of a `Task`.
+template <typename F>
+void Measure(std::string_view name, int iterations, int awaits, F make_task) {
+  alignas(__STDCPP_DEFAULT_NEW_ALIGNMENT__) static std::byte frames[1 << 16];
+  FrameArena arena(frames);
+  const Clock::time_point start = Clock::now();
+  for (int i = 0; i < iterations; i++) {
+    FrameArena::Scope scope(arena);
+    auto task = make_task();
+    task.Start([](int value) { sink = value; });
+  }
+  const Clock::time_point end = Clock::now();
+  const std::chrono::duration<double, std::nano> elapsed = end - start;
+  std::println("{:<16} {:>8} {:>10.1f}", name, awaits,
+               elapsed.count() / (double(iterations) * awaits));
+}
+
+void Run(int argc, char* argv[]) {
+  int iterations = 1'000'000;
+  for (int i = 1; i < argc; i++) {
+    const std::string_view arg = argv[i];
+    if (!arg.starts_with("--iterations=")) {
+      throw std::runtime_error("bad argument: " + std::string(arg));
+    }
+    const std::string_view value = arg.substr(13);
+    auto [end, error] = std::from_chars(value.data(),
+                                        value.data() + value.size(), iterations);
+    if (error != std::errc() || end != value.data() + value.size() ||
+        iterations < 1) {
+      throw std::runtime_error("bad --iterations");
+    }
+  }
+
+  std::println("{:<16} {:>8} {:>10}", "case", "awaits", "ns/await");
+  for (int depth : {1, 4, 16, 64}) {
+    Measure(std::format("chain/{}", depth), iterations / depth, depth,
+            [depth] { return Chain(depth - 1); });
+  }
+  static constexpr std::string_view kInput = "0123456789abcdef";
+  Measure("read_input", iterations / 4, 4, [] {
+    static MemoryStream memory(kInput);
+    static Stream stream(memory);
+    memory = MemoryStream(kInput);
+    return ReadAndCount(stream);
+  });
+}
+
+}  // namespace
+}  // namespace aoc2024
+
+int main(int argc, char* argv[]) {
+  try {
+    aoc2024::Run(argc, argv);
+  } catch (const std::exception& e) {
+    std::println(stderr, "{}", e.what());
+    return 1;
+  }
+}
@@ -0,0 +1,105 @@
+#include "event_loop.hpp"
+
+#include "../common/frame_arena.hpp"
+#include "../common/schedule.hpp"
+
+#include <cassert>
+#include <cerrno>
+#include <iterator>
+#include <sys/epoll.h>
+#include <system_error>
+#include <utility>
+
+namespace aoc2024 {
+namespace {
+
+// Set by SchedulerInit(), after which point it is unchanged.
+int epoll_fd = -1;
+
+BackgroundTask* head;
+BackgroundTask* tail;
+SchedulerStats stats;
+
+// Runs the tasks which are already queued. Anything they schedule waits until
+// after the next poll, so a coroutine which yields (see `MaybeYield()`) can't
+// starve I/O.
+void RunBackgroundTasks() {
+  BackgroundTask* task = std::exchange(head, nullptr);
+  tail = nullptr;
+  while (task) {
+    // The task may be destroyed or rescheduled once it has run.
+    BackgroundTask* const next = task->next;
+    task->func(task->data);
+    task = next;
+  }
+}
+
+void Control(int op, int fd, IoWatcher* watcher) {
+  epoll_event event = {
+      .events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET,
+      .data = {.ptr = watcher},
+  };
+  if (epoll_ctl(epoll_fd, op, fd, &event) == -1) {
+    throw std::system_error(errno, std::generic_category(), "epoll_ctl");
+  }
+}
+
+}  // namespace
+
+bool SchedulerInit() {
+  assert(epoll_fd == -1);
+  epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+  return epoll_fd != -1;
+}
+
+SchedulerStats GetSchedulerStats() {
+  SchedulerStats result = stats;
+  result.frames_allocated = FrameArena::heap_frames();
+  return result;
+}
+
+void CountAllocatedTask() { stats.allocated++; }
+
+void BackgroundTask::Schedule() {
+  stats.scheduled++;
+  next = nullptr;
+  if (tail) {
+    tail->next = this;
+    tail = this;
+  } else {
+    head = tail = this;
+  }
+}
+
+void Watch(int fd, IoWatcher& watcher) { Control(EPOLL_CTL_ADD, fd, &watcher); }
+
+void Rewatch(int fd, IoWatcher& watcher) {
+  Control(EPOLL_CTL_MOD, fd, &watcher);
+}
+
+void Unwatch(int fd) { Control(EPOLL_CTL_DEL, fd, nullptr); }
+
+void RunOnce(int timeout_ms) {
+  assert(epoll_fd != -1);
+  RunBackgroundTasks();
+  epoll_event events[16];
+  const int n = epoll_wait(epoll_fd, events, std::size(events),
+                           head ? 0 : timeout_ms);
+  if (n == -1) {
+    if (errno == EINTR) return;
+    throw std::system_error(errno, std::generic_category(), "epoll_wait");
+  }
+  // Watchers only ever schedule work in response to events, so none of them
+  // can be destroyed part way through this loop.
+  for (int i = 0; i < n; i++) {
+    const IoWatcher& watcher = *static_cast<IoWatcher*>(events[i].data.ptr);
+    watcher.func(watcher.data, events[i].events);
+  }
+  RunBackgroundTasks();
+}
+
+void RunForever() {
+  while (true) RunOnce(-1);
+}
+
+}  // namespace aoc2024
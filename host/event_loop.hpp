@@ -0,0 +1,34 @@
+#ifndef AOC2024_EVENT_LOOP_HPP_
+#define AOC2024_EVENT_LOOP_HPP_
+
+#include <cstdint>
+
+// The host implementation of the scheduler (common/schedule.hpp) is an epoll
+// loop. Background tasks are run between polls, and file descriptors can be
+// watched to receive readiness notifications.
+namespace aoc2024 {
+
+// Receives edge-triggered readiness notifications for a file descriptor. The
+// `events` argument is the epoll event mask.
+struct IoWatcher {
+  void* data;
+  void (*func)(void* data, std::uint32_t events);
+};
+
+// Starts watching `fd` for readability and writability. The watcher must stay
+// at the same address until `Unwatch` is called or `Rewatch` moves it.
+void Watch(int fd, IoWatcher& watcher);
+void Rewatch(int fd, IoWatcher& watcher);
+void Unwatch(int fd);
+
+// Runs all pending background tasks, then waits for up to `timeout_ms`
+// milliseconds (forever if -1, and not at all if those tasks scheduled more)
+// for I/O events and dispatches them.
+void RunOnce(int timeout_ms);
+
+// Runs the event loop forever.
+[[noreturn]] void RunForever();
+
+}  // namespace aoc2024
+
+#endif  // AOC2024_EVENT_LOOP_HPP_
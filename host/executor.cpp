@@ -0,0 +1,74 @@
+#include "../common/parallel.hpp"
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace aoc2024 {
+namespace {
+
+// Emulates the Pico's event signalling (__sev/__wfe) with a generation counter
+// so that a wakeup which happens before a core waits is never lost.
+struct WakeState {
+  std::mutex mutex;
+  std::condition_variable condition;
+  int generation = 0;
+  int seen_generation[kNumCores] = {};
+};
+
+// Set by ExecutorInit(). Neither this nor the executor are ever destroyed:
+// the worker threads are still waiting on them while the process exits.
+WakeState* wake = nullptr;
+
+thread_local int current_core = 0;
+
+struct Platform {
+  using Lock = std::mutex;
+
+  static int CurrentCore() { return current_core; }
+
+  static void Wake() {
+    {
+      std::lock_guard lock(wake->mutex);
+      wake->generation++;
+    }
+    wake->condition.notify_all();
+  }
+
+  static void Wait(int core) {
+    std::unique_lock lock(wake->mutex);
+    wake->condition.wait(
+        lock, [&] { return wake->seen_generation[core] != wake->generation; });
+    wake->seen_generation[core] = wake->generation;
+  }
+};
+
+using Executor = WorkStealingExecutor<Platform>;
+
+Executor* executor = nullptr;
+
+}  // namespace
+
+void ExecutorInit() {
+  assert(!executor);
+  wake = new WakeState;
+  executor = new Executor;
+  // The calling thread acts as core 0. The worker threads run until the
+  // process exits.
+  for (int core = 1; core < kNumCores; core++) {
+    std::thread([core] {
+      current_core = core;
+      executor->Work(core);
+    }).detach();
+  }
+}
+
+void RunParallel(int begin, int end, void* data, ChunkFunction func) {
+  if (!executor) {
+    if (begin < end) func(data, 0, begin, end);
+    return;
+  }
+  executor->Run(begin, end, data, func);
+}
+
+}  // namespace aoc2024
@@ -0,0 +1,44 @@
+#include "../common/coro.hpp"
+#include "../common/parallel.hpp"
+#include "../common/schedule.hpp"
+#include "../server/serve.hpp"
+#include "event_loop.hpp"
+
+#include <charconv>
+#include <cstdlib>
+#include <print>
+#include <string_view>
+
+namespace aoc2024 {
+namespace {
+
+void Run(int argc, char* argv[]) {
+  ServeOptions options;
+  if (argc > 2) {
+    std::println(stderr, "Usage: {} [port]", argv[0]);
+    std::exit(1);
+  }
+  if (argc == 2) {
+    const std::string_view arg = argv[1];
+    auto [end, error] =
+        std::from_chars(arg.data(), arg.data() + arg.size(), options.port);
+    if (error != std::errc() || end != arg.data() + arg.size()) {
+      std::println(stderr, "Bad port: {}", arg);
+      std::exit(1);
+    }
+  }
+  if (!SchedulerInit()) std::exit(1);
+  ExecutorInit();
+
+  Task<void> server = Serve(options);
+  server.Start([] {
+    std::println("Stopped serving.");
+    std::exit(1);
+  });
+  RunForever();
+}
+
+}  // namespace
+}  // namespace aoc2024
+
+int main(int argc, char* argv[]) { aoc2024::Run(argc, argv); }
@@ -0,0 +1,34 @@
+#include "../common/memory.hpp"
+
+#include "../common/tlsf.hpp"
+
+#include <pthread.h>
+#include <stdexcept>
+
+namespace aoc2024 {
+namespace {
+
+// Far more than any request needs. Only the pages which are touched take up
+// any memory.
+constexpr std::size_t kHeapSize = 64 * 1024 * 1024;
+
+}  // namespace
+
+std::byte* StackLimit() {
+  pthread_attr_t attributes;
+  if (pthread_getattr_np(pthread_self(), &attributes) != 0) {
+    throw std::runtime_error("pthread_getattr_np failed");
+  }
+  void* stack;
+  std::size_t size;
+  pthread_attr_getstack(&attributes, &stack, &size);
+  pthread_attr_destroy(&attributes);
+  return static_cast<std::byte*>(stack);
+}
+
+std::span<std::byte> HeapPool() {
+  alignas(Tlsf::kAlignment) static std::byte pool[kHeapSize];
+  return pool;
+}
+
+}  // namespace aoc2024
@@ -0,0 +1,164 @@
+// Checks that `MemoryWatermark` measures what it should, and that a solution
+// which is known to be heavy stays within the memory it would have on the Pico.
+//
+//     aoc_memory_test
+//
+// Exits with a non-zero status (and a message on stderr) if any check fails.
+
+#include "../common/api.hpp"
+#include "../common/coro.hpp"
+#include "../common/frame_arena.hpp"
+#include "../common/memory.hpp"
+#include "../common/parallel.hpp"
+#include "../common/request_arena.hpp"
+#include "../common/schedule.hpp"
+#include "../common/stream.hpp"
+#include "../server/serve.hpp"
+#include "../server/solve.hpp"
+#include "event_loop.hpp"
+
+#include <cstddef>
+#include <format>
+#include <memory>
+#include <print>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace aoc2024 {
+namespace {
+
+// The size of the known stack array and heap allocation.
+constexpr std::size_t kStackArraySize = 16 * 1024;
+constexpr std::size_t kHeapAllocationSize = 32 * 1024;
+
+// Slack for the frames of the functions between the watermark and whatever it
+// is measuring, and for the headers of heap blocks.
+constexpr std::size_t kOverhead = 1024;
+
+// The budget for day 22, which allocates two arrays of 50000 entries however
+// small its input is. The Pico's main stack is the 4 KiB SCRATCH_Y bank, but
+// frames on the host are bigger (and bigger still without optimization), so
+// the stack budget is twice that. The heap budget is roughly what the Pico has
+// left once the server's buffers are allocated.
+constexpr std::size_t kStackBudget = 8 * 1024;
+constexpr std::size_t kHeapBudget = 160 * 1024;
+
+// The example from the puzzle's second part.
+constexpr std::string_view kDay22Input = "1\n2\n3\n2024\n";
+constexpr std::string_view kDay22Answer = "37990510\n23\n";
+
+void Check(bool condition, std::string_view message) {
+  if (!condition) throw std::runtime_error(std::string(message));
+}
+
+// Uses `kStackArraySize` bytes of stack, which the compiler can't elide.
+[[gnu::noinline]] void UseStackArray() {
+  volatile std::byte array[kStackArraySize];
+  for (std::size_t i = 0; i < kStackArraySize; i++) array[i] = std::byte(i);
+}
+
+void TestStackArray() {
+  const MemoryWatermark watermark;
+  UseStackArray();
+  const MemoryUsage usage = watermark.Measure();
+  std::println("stack array: {} bytes of stack", usage.stack_used);
+  Check(usage.stack_used >= kStackArraySize,
+        std::format("stack array of {} bytes measured as {} bytes",
+                    kStackArraySize, usage.stack_used));
+  Check(usage.stack_used <= kStackArraySize + kOverhead,
+        std::format("stack array of {} bytes measured as {} bytes",
+                    kStackArraySize, usage.stack_used));
+}
+
+void TestHeapAllocation() {
+  const MemoryWatermark watermark;
+  // Freed before measuring, which must not hide the peak.
+  std::make_unique<std::byte[]>(kHeapAllocationSize).reset();
+  const MemoryUsage usage = watermark.Measure();
+  std::println("heap allocation: {} bytes of heap in {} allocations",
+               usage.heap_used, usage.heap_allocations);
+  Check(usage.heap_used >= kHeapAllocationSize,
+        std::format("heap allocation of {} bytes measured as {} bytes",
+                    kHeapAllocationSize, usage.heap_used));
+  Check(usage.heap_used <= kHeapAllocationSize + kOverhead,
+        std::format("heap allocation of {} bytes measured as {} bytes",
+                    kHeapAllocationSize, usage.heap_used));
+  Check(usage.heap_allocations == 1,
+        std::format("one heap allocation counted as {}",
+                    usage.heap_allocations));
+}
+
+std::string Answer(const Response& response) {
+  std::string answer;
+  std::span<const char> bytes = response.bytes();
+  while (!bytes.empty()) {
+    const ResponsePacket packet = ResponsePacket::Decode(bytes);
+    if (packet.type == ResponsePacketType::kOutput) answer += packet.text;
+  }
+  return answer;
+}
+
+// Large enough for the frame of any of the solutions.
+constexpr std::size_t kFrameArenaSize = 256 * 1024;
+
+// The same as the server's default, so that scratch memory shows up as heap
+// usage just as it does when serving.
+constexpr std::size_t kRequestBlockSize = ServeOptions().request_block_size;
+
+// Solves `day` the way `aoc_bench` does, returning the answer.
+std::string SolveDay(int day, std::string_view input, MemoryUsage& usage) {
+  alignas(__STDCPP_DEFAULT_NEW_ALIGNMENT__) static std::byte
+      frames[kFrameArenaSize];
+  FrameArena arena(frames);
+  RequestArena scratch(kRequestBlockSize);
+  MemoryStream memory(input);
+  Stream stream(memory);
+  bool solved = false;
+
+  char response_buffer[kResponseBufferSize - ResponseHeader::kNumBytes];
+  Response response(response_buffer, scratch);
+  const MemoryWatermark watermark;
+  Task<void> solve = Solve(day, stream, response, arena);
+  solve.Start([&] { solved = true; });
+  while (!solved) RunOnce(0);
+  usage = watermark.Measure();
+  return Answer(response);
+}
+
+void TestDay22() {
+  MemoryUsage usage;
+  const std::string answer = SolveDay(22, kDay22Input, usage);
+  std::println("day 22: {} bytes of stack, {} bytes of heap", usage.stack_used,
+               usage.heap_used);
+  Check(answer == kDay22Answer, std::format("day 22 answered {:?}", answer));
+  Check(usage.stack_used > 0, "day 22 used no stack");
+  Check(usage.heap_used > 0, "day 22 used no heap");
+  Check(usage.stack_used <= kStackBudget,
+        std::format("day 22 used {} bytes of stack, over the budget of {}",
+                    usage.stack_used, kStackBudget));
+  Check(usage.heap_used <= kHeapBudget,
+        std::format("day 22 used {} bytes of heap, over the budget of {}",
+                    usage.heap_used, kHeapBudget));
+}
+
+void Test() {
+  if (!SchedulerInit()) throw std::runtime_error("SchedulerInit failed");
+  ExecutorInit();
+  TestStackArray();
+  TestHeapAllocation();
+  TestDay22();
+}
+
+}  // namespace
+}  // namespace aoc2024
+
+int main() {
+  try {
+    aoc2024::Test();
+  } catch (const std::exception& e) {
+    std::println(stderr, "{}", e.what());
+    return 1;
+  }
+}
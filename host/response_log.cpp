@@ -0,0 +1,40 @@
+#include "response_log.hpp"
+
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+
+namespace aoc2024 {
+
+void AppendResponse(const std::string& path, int day,
+                    std::span<const char> bytes) {
+  std::ofstream file(path, std::ios::binary | std::ios::app);
+  if (!file) throw std::runtime_error("cannot open " + path);
+  const std::uint32_t size = bytes.size();
+  const char header[5] = {char(day), char(size), char(size >> 8),
+                          char(size >> 16), char(size >> 24)};
+  file.write(header, sizeof(header));
+  file.write(bytes.data(), bytes.size());
+  if (!file) throw std::runtime_error("cannot write " + path);
+}
+
+std::vector<LoggedResponse> ReadResponses(const std::string& path) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) throw std::runtime_error("cannot open " + path);
+  std::vector<LoggedResponse> result;
+  char header[5];
+  while (file.read(header, sizeof(header))) {
+    std::uint32_t size = 0;
+    for (int i = 4; i >= 1; i--) size = size << 8 | std::uint8_t(header[i]);
+    LoggedResponse& response =
+        result.emplace_back(LoggedResponse{.day = header[0], .bytes = {}});
+    response.bytes.resize(size);
+    if (!file.read(response.bytes.data(), size)) {
+      throw std::runtime_error(path + ": truncated record");
+    }
+  }
+  if (file.gcount() != 0) throw std::runtime_error(path + ": truncated header");
+  return result;
+}
+
+}  // namespace aoc2024
@@ -0,0 +1,28 @@
+#ifndef AOC2024_RESPONSE_LOG_HPP_
+#define AOC2024_RESPONSE_LOG_HPP_
+
+#include <span>
+#include <string>
+#include <vector>
+
+// A response log is a file of raw `Response` byte streams, each tagged with the
+// day of the request which produced it. `aoc_client --log=FILE` appends to one
+// and `aoc_trace` reads them. Each record is an 8-bit day, a 32-bit
+// little-endian length, and then the bytes of the response.
+namespace aoc2024 {
+
+struct LoggedResponse {
+  int day;
+  std::string bytes;
+};
+
+// Appends a record to the log at `path`, creating it if necessary.
+void AppendResponse(const std::string& path, int day,
+                    std::span<const char> bytes);
+
+// Reads every record from the log at `path`. Throws if the log is malformed.
+std::vector<LoggedResponse> ReadResponses(const std::string& path);
+
+}  // namespace aoc2024
+
+#endif  // AOC2024_RESPONSE_LOG_HPP_
@@ -0,0 +1,228 @@
+// Compares the throughput of the ways of parsing input in common/scan.hpp and
+// common/integers.hpp.
+//
+//     scan_bench [--iterations=N]
+//
+// Each case scans N lines in the style of one of the solutions, once with the
+// format string interpreted at runtime (`ScanPrefix(input, "...", ...)`), once
+// with it parsed at compile time (`ScanPrefix<"...">(input, ...)`) and, where
+// the line is only integers and punctuation, once with `ExtractIntegers`. It
+// reports the mean time per line and the throughput of each.
+
+#include "../common/integers.hpp"
+#include "../common/scan.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <print>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace aoc2024 {
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Prevents the compiler from optimising away the results.
+volatile std::int64_t sink;
+
+// Returns `n` lines picked at random from `lines`. The order is shuffled so
+// that the branch predictor can't learn the lengths of the values, which
+// would flatter the scans that parse one digit at a time.
+std::string MakeInput(std::string_view lines, int n) {
+  std::vector<std::string_view> choices;
+  while (!lines.empty()) {
+    const std::size_t end = lines.find('\n') + 1;
+    choices.push_back(lines.substr(0, end));
+    lines.remove_prefix(end);
+  }
+  std::minstd_rand random;
+  std::uniform_int_distribution<std::size_t> pick(0, choices.size() - 1);
+  std::string result;
+  for (int i = 0; i < n; i++) result += choices[pick(random)];
+  return result;
+}
+
+// Runs `scan(input)` until it has consumed all of the input and prints the
+// mean time per line and the throughput.
+template <typename F>
+void Measure(std::string_view name, std::string_view input, F scan) {
+  const int lines = std::ranges::count(input, '\n');
+  std::int64_t total = 0;
+  const Clock::time_point start = Clock::now();
+  std::string_view remaining = input;
+  while (!remaining.empty()) total += scan(remaining);
+  const Clock::time_point end = Clock::now();
+  sink = total;
+  const std::chrono::duration<double, std::nano> elapsed = end - start;
+  std::println("{:<20} {:>10.1f} {:>10.1f}", name, elapsed.count() / lines,
+               input.size() / elapsed.count() * 1e3);
+}
+
+// Day 14: robots with a position and velocity.
+constexpr std::string_view kRobots =
+    "p=0,4 v=3,-3\np=6,3 v=-1,-3\np=10,3 v=-1,2\np=2,0 v=2,-1\n"
+    "p=57,100 v=-61,-93\np=98,21 v=35,-68\n";
+
+std::int64_t CheckedSum(bool ok, std::int64_t sum) {
+  if (!ok) throw std::runtime_error("scan failed");
+  return sum;
+}
+
+// Removes the first line from `input` and returns it, without the newline.
+std::string_view TakeLine(std::string_view& input) {
+  const std::size_t end = input.find('\n');
+  const std::string_view line = input.substr(0, end);
+  input.remove_prefix(end + 1);
+  return line;
+}
+
+void BenchRobots(int iterations) {
+  const std::string input = MakeInput(kRobots, iterations);
+  Measure("robots/runtime", input, [](std::string_view& input) {
+    int px, py, vx, vy;
+    const bool ok =
+        ScanPrefix(input, "p={},{} v={},{}\n", px, py, vx, vy);
+    return CheckedSum(ok, px + py + vx + vy);
+  });
+  Measure("robots/compiled", input, [](std::string_view& input) {
+    int px, py, vx, vy;
+    const bool ok = ScanPrefix<"p={},{} v={},{}\n">(input, px, py, vx, vy);
+    return CheckedSum(ok, px + py + vx + vy);
+  });
+  Measure("robots/extract", input, [](std::string_view& input) {
+    int values[4];
+    const bool ok =
+        ExtractIntegers(TakeLine(input), std::span(values)).size() == 4;
+    return CheckedSum(ok, values[0] + values[1] + values[2] + values[3]);
+  });
+}
+
+// Day 7: a target followed by a variable number of values.
+constexpr std::string_view kRecords =
+    "190: 10 19\n3267: 81 40 27\n21037: 9 7 18 13\n"
+    "292: 11 6 16 20\n7290: 6 8 6 15\n161011: 16 10 13\n";
+
+void BenchRecords(int iterations) {
+  const std::string input = MakeInput(kRecords, iterations);
+  Measure("records/runtime", input, [](std::string_view& input) {
+    std::uint64_t target;
+    std::uint16_t value;
+    bool ok = ScanPrefix(input, "{}: {}", target, value);
+    std::int64_t sum = target + value;
+    while (ok && !ScanPrefix(input, "\n")) {
+      ok = ScanPrefix(input, " {}", value);
+      sum += value;
+    }
+    return CheckedSum(ok, sum);
+  });
+  Measure("records/compiled", input, [](std::string_view& input) {
+    std::uint64_t target;
+    std::uint16_t value;
+    bool ok = ScanPrefix<"{}: {}">(input, target, value);
+    std::int64_t sum = target + value;
+    while (ok && !ScanPrefix<"\n">(input)) {
+      ok = ScanPrefix<" {}">(input, value);
+      sum += value;
+    }
+    return CheckedSum(ok, sum);
+  });
+}
+
+// Day 18: coordinates.
+constexpr std::string_view kCoordinates =
+    "5,4\n4,2\n4,5\n3,0\n2,1\n6,3\n2,4\n1,5\n0,6\n3,3\n2,6\n5,1\n"
+    "41,67\n70,70\n";
+
+void BenchCoordinates(int iterations) {
+  const std::string input = MakeInput(kCoordinates, iterations);
+  Measure("coordinates/runtime", input, [](std::string_view& input) {
+    std::uint8_t x, y;
+    const bool ok = ScanPrefix(input, "{},{}\n", x, y);
+    return CheckedSum(ok, x + y);
+  });
+  Measure("coordinates/compiled", input, [](std::string_view& input) {
+    std::uint8_t x, y;
+    const bool ok = ScanPrefix<"{},{}\n">(input, x, y);
+    return CheckedSum(ok, x + y);
+  });
+  Measure("coordinates/extract", input, [](std::string_view& input) {
+    std::uint8_t xy[2];
+    const bool ok = ExtractIntegers(TakeLine(input), std::span(xy)).size() == 2;
+    return CheckedSum(ok, xy[0] + xy[1]);
+  });
+}
+
+// Day 22: one value per line.
+constexpr std::string_view kValues =
+    "1\n10\n100\n2024\n15887950\n16495136\n527345\n704524\n1553684\n";
+
+void BenchValues(int iterations) {
+  const std::string input = MakeInput(kValues, iterations);
+  Measure("values/runtime", input, [](std::string_view& input) {
+    int value;
+    const bool ok = ScanPrefix(input, "{}\n", value);
+    return CheckedSum(ok, value);
+  });
+  Measure("values/compiled", input, [](std::string_view& input) {
+    int value;
+    const bool ok = ScanPrefix<"{}\n">(input, value);
+    return CheckedSum(ok, value);
+  });
+  Measure("values/extract", input, [](std::string_view& input) {
+    int value[1];
+    const bool ok =
+        ExtractIntegers(TakeLine(input), std::span(value)).size() == 1;
+    return CheckedSum(ok, value[0]);
+  });
+  // The whole input at once, like day 22.
+  std::vector<int> values(iterations + kValues.size());
+  Measure("values/bulk", input, [&values](std::string_view& input) {
+    const std::span<const int> result =
+        ExtractIntegers(std::exchange(input, {}), std::span(values));
+    return std::accumulate(result.begin(), result.end(), std::int64_t(0));
+  });
+}
+
+void Run(int argc, char* argv[]) {
+  int iterations = 1'000'000;
+  for (int i = 1; i < argc; i++) {
+    const std::string_view arg = argv[i];
+    if (!arg.starts_with("--iterations=")) {
+      throw std::runtime_error("bad argument: " + std::string(arg));
+    }
+    const std::string_view value = arg.substr(13);
+    auto [end, error] = std::from_chars(value.data(),
+                                        value.data() + value.size(), iterations);
+    if (error != std::errc() || end != value.data() + value.size() ||
+        iterations < 1) {
+      throw std::runtime_error("bad --iterations");
+    }
+  }
+
+  std::println("{:<20} {:>10} {:>10}", "case", "ns/line", "MB/s");
+  BenchRobots(iterations);
+  BenchRecords(iterations);
+  BenchCoordinates(iterations);
+  BenchValues(iterations);
+}
+
+}  // namespace
+}  // namespace aoc2024
+
+int main(int argc, char* argv[]) {
+  try {
+    aoc2024::Run(argc, argv);
+  } catch (const std::exception& e) {
+    std::println(stderr, "{}", e.what());
+    return 1;
+  }
+}
@@ -0,0 +1,395 @@
+#include "tcp.hpp"
+
+#include "../common/schedule.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace aoc2024::tcp {
+
+FileDescriptor::~FileDescriptor() {
+  if (fd_ != -1) close(fd_);
+}
+
+FileDescriptor& FileDescriptor::operator=(FileDescriptor&& other) noexcept {
+  if (fd_ != -1) close(fd_);
+  fd_ = std::exchange(other.fd_, -1);
+  return *this;
+}
+
+Socket::~Socket() {
+  if (!handle_) return;
+  UnsetCallbacks();
+}
+
+Socket::Socket(Socket&& other) noexcept
+    : pending_read_(std::exchange(other.pending_read_, nullptr)),
+      pending_receive_(std::exchange(other.pending_receive_, nullptr)),
+      received_(std::move(other.received_)),
+      pending_write_(std::exchange(other.pending_write_, nullptr)),
+      receive_eof_(std::exchange(other.receive_eof_, true)) {
+  other.UnsetCallbacks();
+  handle_ = std::move(other.handle_);
+  SetCallbacks();
+}
+
+Socket& Socket::operator=(Socket&& other) noexcept {
+  UnsetCallbacks();
+  other.UnsetCallbacks();
+  handle_ = std::move(other.handle_);
+  pending_read_ = std::exchange(other.pending_read_, nullptr);
+  pending_receive_ = std::exchange(other.pending_receive_, nullptr);
+  received_ = std::move(other.received_);
+  pending_write_ = std::exchange(other.pending_write_, nullptr);
+  receive_eof_ = std::exchange(other.receive_eof_, true);
+  SetCallbacks();
+  return *this;
+}
+
+Socket::ReadAwaitable Socket::Read(std::span<char> buffer) {
+  assert(handle_);
+  return ReadAwaitable(*this, buffer, false);
+}
+
+Socket::ReadAwaitable Socket::ReadChunk(std::span<char> buffer) {
+  assert(handle_);
+  return ReadAwaitable(*this, buffer, true);
+}
+
+Socket::ReceiveAwaitable Socket::Receive(std::size_t min_bytes) {
+  assert(handle_);
+  return ReceiveAwaitable(*this, min_bytes);
+}
+
+void Socket::Consume(std::size_t n) {
+  assert(n <= received_.size());
+  received_.erase(0, n);
+}
+
+Socket::WriteAwaitable Socket::Write(std::span<const char> bytes) {
+  assert(handle_);
+  return WriteAwaitable(*this, bytes);
+}
+
+Socket::Socket(FileDescriptor handle) : handle_(std::move(handle)) {
+  SetCallbacks();
+}
+
+void Socket::OnReady(std::uint32_t events) {
+  constexpr std::uint32_t kReadable =
+      EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR;
+  constexpr std::uint32_t kWritable = EPOLLOUT | EPOLLHUP | EPOLLERR;
+  if (pending_read_ && (events & kReadable)) ReadData();
+  if (pending_receive_ && (events & kReadable)) ReceiveData();
+  if (pending_write_ && (events & kWritable)) WriteData();
+}
+
+void Socket::ReadData() {
+  while (pending_read_) {
+    const std::span<char> destination = pending_read_->unused();
+    if (!received_.empty()) {
+      // Bytes which were buffered by `Receive` come first.
+      const std::size_t n = std::min(destination.size(), received_.size());
+      std::ranges::copy(received_.substr(0, n), destination.begin());
+      received_.erase(0, n);
+      pending_read_->Received(n);
+      continue;
+    }
+    if (receive_eof_) return pending_read_->Done();
+    const ssize_t n = read(handle_.get(), destination.data(),
+                           destination.size());
+    if (n > 0) {
+      pending_read_->Received(n);
+    } else if (n == 0) {
+      receive_eof_ = true;
+    } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+      return;  // Wait for the socket to become readable again.
+    } else if (errno != EINTR) {
+      return pending_read_->Fail(errno);
+    }
+  }
+}
+
+void Socket::ReceiveData() {
+  constexpr std::size_t kChunkSize = 4096;
+  while (pending_receive_) {
+    if (pending_receive_->Satisfied()) return pending_receive_->Done();
+    const std::size_t size = received_.size();
+    received_.resize(size + kChunkSize);
+    const ssize_t n = read(handle_.get(), received_.data() + size, kChunkSize);
+    received_.resize(size + std::max<ssize_t>(n, 0));
+    if (n > 0) continue;
+    if (n == 0) {
+      receive_eof_ = true;
+    } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+      return;  // Wait for the socket to become readable again.
+    } else if (errno != EINTR) {
+      return pending_receive_->Fail(errno);
+    }
+  }
+}
+
+void Socket::WriteData() {
+  while (pending_write_) {
+    const std::span<const char> unsent = pending_write_->unsent();
+    const ssize_t n =
+        send(handle_.get(), unsent.data(), unsent.size(), MSG_NOSIGNAL);
+    if (n >= 0) {
+      pending_write_->Sent(n);
+    } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+      return;  // Wait for the socket to become writable again.
+    } else if (errno != EINTR) {
+      return pending_write_->Fail(errno);
+    }
+  }
+}
+
+void Socket::SetCallbacks() {
+  if (!handle_) return;
+  watcher_ = {
+      .data = this,
+      .func = [](void* self, std::uint32_t events) {
+        reinterpret_cast<Socket*>(self)->OnReady(events);
+      },
+  };
+  Watch(handle_.get(), watcher_);
+}
+
+void Socket::UnsetCallbacks() {
+  if (!handle_) return;
+  Unwatch(handle_.get());
+}
+
+Acceptor::Acceptor(int port, int backlog) {
+  handle_ = FileDescriptor(
+      socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0));
+  if (!handle_) throw AcceptorError("Failed to create acceptor socket.");
+  const int enable = 1;
+  if (setsockopt(handle_.get(), SOL_SOCKET, SO_REUSEADDR, &enable,
+                 sizeof(enable)) == -1) {
+    throw AcceptorError("Failed to configure acceptor socket.");
+  }
+  const sockaddr_in address = {
+      .sin_family = AF_INET,
+      .sin_port = htons(port),
+      .sin_addr = {.s_addr = htonl(INADDR_ANY)},
+      .sin_zero = {},
+  };
+  if (bind(handle_.get(), reinterpret_cast<const sockaddr*>(&address),
+           sizeof(address)) == -1) {
+    throw AcceptorError("Failed to bind to serving port.");
+  }
+  if (listen(handle_.get(), backlog) == -1) {
+    throw AcceptorError("Failed to listen for connections.");
+  }
+
+  SetCallbacks();
+}
+
+Acceptor::~Acceptor() {
+  if (!handle_) return;
+  UnsetCallbacks();
+}
+
+Acceptor::Acceptor(Acceptor&& other) noexcept
+    : pending_accept_(std::exchange(other.pending_accept_, nullptr)) {
+  other.UnsetCallbacks();
+  handle_ = std::move(other.handle_);
+  SetCallbacks();
+}
+
+Acceptor& Acceptor::operator=(Acceptor&& other) noexcept {
+  UnsetCallbacks();
+  other.UnsetCallbacks();
+  handle_ = std::move(other.handle_);
+  pending_accept_ = std::exchange(other.pending_accept_, nullptr);
+  SetCallbacks();
+  return *this;
+}
+
+Acceptor::AcceptAwaitable Acceptor::Accept() {
+  assert(handle_);
+  return AcceptAwaitable(*this);
+}
+
+void Acceptor::OnReady(std::uint32_t events) {
+  if (pending_accept_ && (events & (EPOLLIN | EPOLLERR))) AcceptConnection();
+}
+
+void Acceptor::AcceptConnection() {
+  assert(pending_accept_);
+  while (true) {
+    const int client =
+        accept4(handle_.get(), nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (client != -1) return pending_accept_->Resolve(FileDescriptor(client));
+    switch (errno) {
+      case EAGAIN:
+#if EAGAIN != EWOULDBLOCK
+      case EWOULDBLOCK:
+#endif
+        return;  // Wait for another connection attempt.
+      case EINTR:
+      case ECONNABORTED:
+        continue;  // Transient: try again.
+      default:
+        return pending_accept_->Fail(errno);
+    }
+  }
+}
+
+void Acceptor::SetCallbacks() {
+  if (!handle_) return;
+  watcher_ = {
+      .data = this,
+      .func = [](void* self, std::uint32_t events) {
+        reinterpret_cast<Acceptor*>(self)->OnReady(events);
+      },
+  };
+  Watch(handle_.get(), watcher_);
+}
+
+void Acceptor::UnsetCallbacks() {
+  if (!handle_) return;
+  Unwatch(handle_.get());
+}
+
+bool Socket::ReadAwaitable::await_ready() const { return false; }
+
+void Socket::ReadAwaitable::await_suspend(std::coroutine_handle<> awaiter) {
+  awaiter_ = awaiter;
+  assert(!socket_.pending_read_);
+  socket_.pending_read_ = this;
+  if (buffer_.empty()) return Done();
+  socket_.ReadData();
+}
+
+std::span<char> Socket::ReadAwaitable::await_resume() {
+  if (error_ != 0) throw SocketError("Read error");
+  return buffer_.subspan(0, num_bytes_);
+}
+
+std::span<char> Socket::ReadAwaitable::unused() const {
+  return buffer_.subspan(num_bytes_);
+}
+
+void Socket::ReadAwaitable::Done() {
+  assert(socket_.pending_read_ == this);
+  socket_.pending_read_ = nullptr;
+  Schedule(resume_, awaiter_);
+}
+
+void Socket::ReadAwaitable::Received(int n) {
+  assert(num_bytes_ + n <= int(buffer_.size()));
+  num_bytes_ += n;
+  if (chunk_ || num_bytes_ == int(buffer_.size())) Done();
+}
+
+void Socket::ReadAwaitable::Fail(int error) {
+  error_ = error;
+  Done();
+}
+
+bool Socket::ReceiveAwaitable::await_ready() const { return Satisfied(); }
+
+void Socket::ReceiveAwaitable::await_suspend(std::coroutine_handle<> awaiter) {
+  awaiter_ = awaiter;
+  assert(!socket_.pending_receive_);
+  socket_.pending_receive_ = this;
+  socket_.ReceiveData();
+}
+
+std::span<const std::string_view> Socket::ReceiveAwaitable::await_resume() {
+  if (error_ != 0) throw SocketError("Receive error");
+  socket_.segment_ = socket_.received_;
+  return std::span<const std::string_view>(
+      &socket_.segment_, socket_.segment_.empty() ? 0 : 1);
+}
+
+bool Socket::ReceiveAwaitable::Satisfied() const {
+  return socket_.receive_eof_ || socket_.received_.size() >= min_bytes_;
+}
+
+void Socket::ReceiveAwaitable::Done() {
+  assert(socket_.pending_receive_ == this);
+  socket_.pending_receive_ = nullptr;
+  Schedule(resume_, awaiter_);
+}
+
+void Socket::ReceiveAwaitable::Fail(int error) {
+  error_ = error;
+  Done();
+}
+
+bool Socket::WriteAwaitable::await_ready() const { return bytes_.empty(); }
+
+void Socket::WriteAwaitable::await_suspend(std::coroutine_handle<> awaiter) {
+  awaiter_ = awaiter;
+  assert(!socket_.pending_write_);
+  socket_.pending_write_ = this;
+  socket_.WriteData();
+}
+
+void Socket::WriteAwaitable::await_resume() {
+  if (error_ != 0) throw SocketError("Write error");
+}
+
+std::span<const char> Socket::WriteAwaitable::unsent() const {
+  return bytes_.subspan(sent_);
+}
+
+void Socket::WriteAwaitable::Done() {
+  assert(socket_.pending_write_ == this);
+  socket_.pending_write_ = nullptr;
+  Schedule(resume_, awaiter_);
+}
+
+void Socket::WriteAwaitable::Sent(int n) {
+  assert(sent_ + n <= int(bytes_.size()));
+  sent_ += n;
+  if (sent_ == int(bytes_.size())) Done();
+}
+
+void Socket::WriteAwaitable::Fail(int error) {
+  error_ = error;
+  Done();
+}
+
+bool Acceptor::AcceptAwaitable::await_ready() const { return false; }
+
+void Acceptor::AcceptAwaitable::await_suspend(std::coroutine_handle<> awaiter) {
+  awaiter_ = awaiter;
+  assert(!acceptor_.pending_accept_);
+  acceptor_.pending_accept_ = this;
+  acceptor_.AcceptConnection();
+}
+
+Socket Acceptor::AcceptAwaitable::await_resume() {
+  if (result_) {
+    return std::move(*result_);
+  } else {
+    throw AcceptorError("Failed to accept connection");
+  }
+}
+
+void Acceptor::AcceptAwaitable::Done() {
+  assert(acceptor_.pending_accept_ == this);
+  acceptor_.pending_accept_ = nullptr;
+  Schedule(resume_, awaiter_);
+}
+
+void Acceptor::AcceptAwaitable::Resolve(FileDescriptor handle) {
+  result_ = Socket(std::move(handle));
+  Done();
+}
+
+void Acceptor::AcceptAwaitable::Fail(int error) {
+  result_ = std::unexpected(error);
+  Done();
+}
+
+}  // namespace aoc2024::tcp
@@ -0,0 +1,271 @@
+#ifndef AOC2024_TCP_HPP_
+#define AOC2024_TCP_HPP_
+
+#include "../common/coro.hpp"
+#include "../common/schedule.hpp"
+#include "event_loop.hpp"
+
+#include <coroutine>
+#include <expected>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+
+// A host implementation of the interface in pico/tcp.hpp, using non-blocking
+// POSIX sockets driven by the epoll loop in event_loop.hpp.
+namespace aoc2024::tcp {
+
+// Owns a file descriptor and closes it when destroyed.
+class FileDescriptor {
+ public:
+  FileDescriptor() = default;
+  explicit FileDescriptor(int fd) : fd_(fd) {}
+  ~FileDescriptor();
+
+  // Not copyable.
+  FileDescriptor(const FileDescriptor&) = delete;
+  FileDescriptor& operator=(const FileDescriptor&) = delete;
+
+  // Movable.
+  FileDescriptor(FileDescriptor&& other) noexcept
+      : fd_(std::exchange(other.fd_, -1)) {}
+  FileDescriptor& operator=(FileDescriptor&& other) noexcept;
+
+  explicit operator bool() const { return fd_ != -1; }
+  int get() const { return fd_; }
+
+ private:
+  int fd_ = -1;
+};
+
+// A single TCP connection. Neither threadsafe nor reentrant.
+class Socket {
+ public:
+  Socket() = default;
+  ~Socket();
+
+  // Not copyable.
+  Socket(const Socket&) = delete;
+  Socket& operator=(const Socket&) = delete;
+
+  // Movable.
+  Socket(Socket&&) noexcept;
+  Socket& operator=(Socket&&) noexcept;
+
+  // Reads bytes into the provided buffer until either the buffer is full or the
+  // socket has been closed for sending by the peer. On success, the awaitable
+  // yields a span containing the bytes that were read. On error, an exception
+  // is thrown.
+  class ReadAwaitable;
+  ReadAwaitable Read(std::span<char> buffer);
+
+  // Like `Read`, but completes as soon as any bytes are available instead of
+  // waiting for the buffer to be full. An empty span indicates that the peer
+  // has closed the socket for sending.
+  ReadAwaitable ReadChunk(std::span<char> buffer);
+
+  // Waits until at least `min_bytes` bytes have been received and not yet
+  // consumed, or until the peer has closed the socket for sending. The host
+  // has no equivalent of pbuf chains, so the bytes are buffered by the socket
+  // and yielded as a single segment. The view remains valid until the next
+  // call to `Consume`.
+  class ReceiveAwaitable;
+  ReceiveAwaitable Receive(std::size_t min_bytes);
+
+  // Releases the first `n` bytes yielded by `Receive`.
+  void Consume(std::size_t n);
+
+  // Writes the given bytes to the socket. On error, an exception is thrown.
+  class WriteAwaitable;
+  WriteAwaitable Write(std::span<const char> bytes);
+
+ private:
+  friend class Acceptor;
+
+  explicit Socket(FileDescriptor handle);
+
+  void OnReady(std::uint32_t events);
+  void ReadData();
+  void ReceiveData();
+  void WriteData();
+
+  void SetCallbacks();
+  void UnsetCallbacks();
+
+  FileDescriptor handle_;
+  IoWatcher watcher_ = {};
+
+  // A pending read which has not yet received as much data as it requested.
+  ReadAwaitable* pending_read_ = nullptr;
+  // A pending receive which has not yet received as much data as it requested.
+  ReceiveAwaitable* pending_receive_ = nullptr;
+  // Bytes which have been received by `Receive` but have not been consumed.
+  std::string received_;
+  std::string_view segment_;
+  // A pending write which has not yet sent as much data as it needs to.
+  WriteAwaitable* pending_write_ = nullptr;
+
+  bool receive_eof_ = false;
+};
+
+// Listens on a port and accepts incoming connections. Up to `backlog`
+// connections which arrive while nobody is waiting in `Accept` are queued and
+// handed out in the order they arrived. Neither threadsafe nor reentrant.
+class Acceptor {
+ public:
+  explicit Acceptor(int port, int backlog = 1);
+  ~Acceptor();
+
+  // Not copyable.
+  Acceptor(const Acceptor&) = delete;
+  Acceptor& operator=(const Acceptor&) = delete;
+
+  // Movable.
+  Acceptor(Acceptor&&) noexcept;
+  Acceptor& operator=(Acceptor&&) noexcept;
+
+  // Accept a new connection. On success, the awaitable yields a Socket
+  // connected to the peer. On failure, an exception is thrown.
+  class AcceptAwaitable;
+  AcceptAwaitable Accept();
+
+ private:
+  void OnReady(std::uint32_t events);
+  void AcceptConnection();
+
+  void SetCallbacks();
+  void UnsetCallbacks();
+
+  FileDescriptor handle_;
+  IoWatcher watcher_ = {};
+  AcceptAwaitable* pending_accept_ = nullptr;
+};
+
+class Error : public std::exception {
+ public:
+  explicit Error(const char* message) : message_(message) {}
+  virtual const char* type() const noexcept { return "Error"; }
+  const char* what() const noexcept override { return message_; }
+
+ private:
+  const char* message_;
+};
+
+class SocketError : public Error {
+ public:
+  using Error::Error;
+  const char* type() const noexcept override { return "SocketError"; }
+};
+
+class AcceptorError : public Error {
+ public:
+  using Error::Error;
+  const char* type() const noexcept override { return "AcceptorError"; }
+};
+
+class [[nodiscard]] Socket::ReadAwaitable {
+ public:
+  bool await_ready() const;
+  void await_suspend(std::coroutine_handle<> awaiter);
+  std::span<char> await_resume();
+
+ private:
+  friend class Socket;
+
+  explicit ReadAwaitable(Socket& socket, std::span<char> buffer, bool chunk)
+      : socket_(socket), buffer_(buffer), chunk_(chunk) {}
+
+  std::span<char> unused() const;
+
+  void Done();
+  void Received(int n);
+  void Fail(int error);
+
+  Socket& socket_;
+  std::span<char> buffer_;
+  // If true, the read completes as soon as any bytes have been received.
+  bool chunk_;
+  int num_bytes_ = 0;
+  // An errno value, or 0 on success.
+  int error_ = 0;
+  std::coroutine_handle<> awaiter_;
+  BackgroundTask resume_;
+};
+
+class [[nodiscard]] Socket::ReceiveAwaitable {
+ public:
+  bool await_ready() const;
+  void await_suspend(std::coroutine_handle<> awaiter);
+  std::span<const std::string_view> await_resume();
+
+ private:
+  friend class Socket;
+
+  explicit ReceiveAwaitable(Socket& socket, std::size_t min_bytes)
+      : socket_(socket), min_bytes_(min_bytes) {}
+
+  bool Satisfied() const;
+  void Done();
+  void Fail(int error);
+
+  Socket& socket_;
+  std::size_t min_bytes_;
+  // An errno value, or 0 on success.
+  int error_ = 0;
+  std::coroutine_handle<> awaiter_;
+  BackgroundTask resume_;
+};
+
+class [[nodiscard]] Socket::WriteAwaitable {
+ public:
+  bool await_ready() const;
+  void await_suspend(std::coroutine_handle<> awaiter);
+  void await_resume();
+
+ private:
+  friend class Socket;
+
+  explicit WriteAwaitable(Socket& socket, std::span<const char> bytes)
+      : socket_(socket), bytes_(bytes) {}
+
+  std::span<const char> unsent() const;
+
+  void Done();
+  void Sent(int n);
+  void Fail(int error);
+
+  Socket& socket_;
+  std::span<const char> bytes_;
+  int sent_ = 0;
+  // An errno value, or 0 on success.
+  int error_ = 0;
+  std::coroutine_handle<> awaiter_;
+  BackgroundTask resume_;
+};
+
+class [[nodiscard]] Acceptor::AcceptAwaitable {
+ public:
+  bool await_ready() const;
+  void await_suspend(std::coroutine_handle<> handle);
+  Socket await_resume();
+
+ private:
+  friend class Acceptor;
+
+  explicit AcceptAwaitable(Acceptor& acceptor) : acceptor_(acceptor) {}
+
+  void Done();
+  void Resolve(FileDescriptor handle);
+  void Fail(int error);
+
+  Acceptor& acceptor_;
+  std::expected<Socket, int> result_;
+  std::coroutine_handle<> awaiter_;
+  BackgroundTask resume_;
+};
+
+}  // namespace aoc2024::tcp
+
+#endif  // AOC2024_TCP_HPP_
@@ -0,0 +1,233 @@
+// Decodes response logs written by `aoc_client --log=FILE`.
+//
+//     aoc_trace [--json=FILE] LOG...
+//
+// For each day, prints latency histograms for each phase of the request (as
+// recorded by the solution's events) and for each labelled span. With
+// `--json`, also writes the timeline of every request in the Chrome trace event
+// format, which can be opened in chrome://tracing or https://ui.perfetto.dev:
+// each day is a process and each request is a thread within it.
+
+#include "../common/api.hpp"
+#include "response_log.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <format>
+#include <fstream>
+#include <map>
+#include <print>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace aoc2024 {
+namespace {
+
+using Duration = std::chrono::microseconds;
+
+struct Options {
+  std::string json;
+  std::vector<std::string> logs;
+};
+
+// A named interval within a request, relative to the start of the request.
+struct Interval {
+  std::string name;
+  Duration start, duration;
+  int depth;
+};
+
+// The timeline of a single request.
+struct Request {
+  int day;
+  std::vector<Interval> phases;
+  std::vector<Interval> spans;
+};
+
+// Reconstructs the timeline of a request from its response. Each phase runs
+// from the previous event that was recorded (or the start of the request) to
+// the event which ends it.
+Request Decode(const LoggedResponse& logged) {
+  Request request{.day = logged.day, .phases = {}, .spans = {}};
+  Duration previous = {};
+  std::span<const char> bytes = logged.bytes;
+  while (!bytes.empty()) {
+    const ResponsePacket packet = ResponsePacket::Decode(bytes);
+    if (packet.type != ResponsePacketType::kEvent) continue;
+    if (packet.event == Event::kMemory) continue;
+    if (packet.event == Event::kSpan) {
+      request.spans.push_back({.name = std::string(packet.label),
+                               .start = packet.time,
+                               .duration = packet.duration,
+                               .depth = packet.depth});
+    } else {
+      request.phases.push_back({.name = EventName(packet.event),
+                                .start = previous,
+                                .duration = packet.time - previous,
+                                .depth = 0});
+      previous = packet.time;
+    }
+  }
+  return request;
+}
+
+std::string JsonString(std::string_view text) {
+  std::string result = "\"";
+  for (char c : text) {
+    if (c == '"' || c == '\\') {
+      result += '\\';
+      result += c;
+    } else if (std::uint8_t(c) < 0x20) {
+      result += std::format("\\u{:04x}", int(c));
+    } else {
+      result += c;
+    }
+  }
+  result += '"';
+  return result;
+}
+
+void WriteChromeTrace(const std::string& path,
+                      std::span<const Request> requests) {
+  std::ofstream file(path);
+  if (!file) throw std::runtime_error("cannot open " + path);
+  file << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+  bool first = true;
+  const auto emit = [&](const std::string& event) {
+    if (!first) file << ",\n";
+    first = false;
+    file << event;
+  };
+  std::map<int, int> runs;  // Number of requests seen so far for each day.
+  for (const Request& request : requests) {
+    const int run = runs[request.day]++;
+    if (run == 0) {
+      emit(std::format(
+          "{{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": {}, "
+          "\"args\": {{\"name\": \"day {:02}\"}}}}",
+          request.day, request.day));
+    }
+    const auto emit_interval = [&](const Interval& interval,
+                                   std::string_view category) {
+      emit(std::format(
+          "{{\"name\": {}, \"cat\": \"{}\", \"ph\": \"X\", \"ts\": {}, "
+          "\"dur\": {}, \"pid\": {}, \"tid\": {}}}",
+          JsonString(interval.name), category, interval.start.count(),
+          interval.duration.count(), request.day, run));
+    };
+    for (const Interval& phase : request.phases) emit_interval(phase, "phase");
+    for (const Interval& span : request.spans) emit_interval(span, "span");
+  }
+  file << "\n]}\n";
+  if (!file) throw std::runtime_error("cannot write " + path);
+}
+
+Duration Percentile(std::span<const Duration> sorted, int percent) {
+  const int n = sorted.size();
+  const int i = std::min(n - 1, (n * percent + 99) / 100 - 1);
+  return sorted[std::max(i, 0)];
+}
+
+// Formats the number of samples in each power-of-two bucket of microseconds,
+// from the bucket of the minimum to the bucket of the maximum.
+std::string Histogram(std::span<const Duration> sorted) {
+  const auto bucket = [](Duration d) {
+    return std::bit_width(std::uint64_t(std::max<std::int64_t>(d.count(), 0)));
+  };
+  const int first = bucket(sorted.front()), last = bucket(sorted.back());
+  std::vector<int> counts(last - first + 1);
+  for (Duration d : sorted) counts[bucket(d) - first]++;
+  std::string result = std::format("[{}us", first == 0 ? 0 : 1 << (first - 1));
+  for (int count : counts) result += std::format(" {}", count);
+  result += std::format(" {}us)", std::uint64_t(1) << last);
+  return result;
+}
+
+void PrintHistograms(std::span<const Request> requests) {
+  // Samples for each day, keyed by phase or span name in order of appearance.
+  struct Day {
+    int runs = 0;
+    std::vector<std::string> names;
+    std::map<std::string, std::vector<Duration>> samples;
+  };
+  std::map<int, Day> days;
+  for (const Request& request : requests) {
+    Day& day = days[request.day];
+    day.runs++;
+    const auto add = [&](const std::string& name, Duration duration) {
+      auto [i, is_new] = day.samples.try_emplace(name);
+      if (is_new) day.names.push_back(name);
+      i->second.push_back(duration);
+    };
+    for (const Interval& phase : request.phases) {
+      add(phase.name, phase.duration);
+    }
+    for (const Interval& span : request.spans) {
+      add(std::string(2 * span.depth, ' ') + "[" + span.name + "]",
+          span.duration);
+    }
+  }
+  for (auto& [number, day] : days) {
+    std::println("day {:02} ({} requests)", number, day.runs);
+    std::println("  {:<24} {:>6} {:>9} {:>9} {:>9} {:>9} {:>9}  {}", "phase",
+                 "n", "min_us", "p50_us", "p90_us", "p99_us", "max_us",
+                 "histogram (log2 buckets)");
+    for (const std::string& name : day.names) {
+      std::vector<Duration>& samples = day.samples[name];
+      std::ranges::sort(samples);
+      std::println("  {:<24} {:>6} {:>9} {:>9} {:>9} {:>9} {:>9}  {}", name,
+                   samples.size(), samples.front().count(),
+                   Percentile(samples, 50).count(),
+                   Percentile(samples, 90).count(),
+                   Percentile(samples, 99).count(), samples.back().count(),
+                   Histogram(samples));
+    }
+  }
+}
+
+Options ParseOptions(int argc, char* argv[]) {
+  Options options;
+  for (int i = 1; i < argc; i++) {
+    const std::string_view arg = argv[i];
+    if (arg.starts_with("--json=")) {
+      options.json = arg.substr(7);
+    } else if (arg.starts_with("--")) {
+      throw std::runtime_error("bad argument: " + std::string(arg));
+    } else {
+      options.logs.emplace_back(arg);
+    }
+  }
+  if (options.logs.empty()) {
+    throw std::runtime_error("Usage: aoc_trace [--json=FILE] LOG...");
+  }
+  return options;
+}
+
+void Run(int argc, char* argv[]) {
+  const Options options = ParseOptions(argc, argv);
+  std::vector<Request> requests;
+  for (const std::string& log : options.logs) {
+    for (const LoggedResponse& response : ReadResponses(log)) {
+      requests.push_back(Decode(response));
+    }
+  }
+  PrintHistograms(requests);
+  if (!options.json.empty()) WriteChromeTrace(options.json, requests);
+}
+
+}  // namespace
+}  // namespace aoc2024
+
+int main(int argc, char* argv[]) {
+  try {
+    aoc2024::Run(argc, argv);
+  } catch (const std::exception& e) {
+    std::println(stderr, "{}", e.what());
+    return 1;
+  }
+}
@@ -0,0 +1,39 @@
+#include "../common/answer_cache.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <hardware/flash.h>
+#include <pico/flash.h>
+#include <stdexcept>
+
+namespace aoc2024 {
+namespace {
+
+// The cache lives in the last sector of flash, which is far beyond the end of
+// the program.
+constexpr std::uint32_t kOffset = PICO_FLASH_SIZE_BYTES - FLASH_SECTOR_SIZE;
+static_assert(AnswerCache::kCapacity == FLASH_SECTOR_SIZE);
+
+void WriteSector(void* data) {
+  flash_range_erase(kOffset, FLASH_SECTOR_SIZE);
+  flash_range_program(kOffset, static_cast<const std::uint8_t*>(data),
+                      FLASH_SECTOR_SIZE);
+}
+
+}  // namespace
+
+void LoadAnswerCache(std::span<char, AnswerCache::kCapacity> data) {
+  std::memcpy(data.data(), reinterpret_cast<const void*>(XIP_BASE + kOffset),
+              data.size());
+}
+
+void StoreAnswerCache(std::span<const char, AnswerCache::kCapacity> data) {
+  // Nothing can run from flash while it is being written, so this pauses core
+  // 1 (see ExecutorInit) and disables interrupts on this core.
+  constexpr std::uint32_t kTimeoutMs = 100;
+  const int result = flash_safe_execute(
+      WriteSector, const_cast<char*>(data.data()), kTimeoutMs);
+  if (result != PICO_OK) throw std::runtime_error("cannot write answer cache");
+}
+
+}  // namespace aoc2024
@@ -0,0 +1,65 @@
+#include "../common/parallel.hpp"
+
+#include <cstdint>
+#include <hardware/sync.h>
+#include <pico/multicore.h>
+
+namespace aoc2024 {
+namespace {
+
+struct Platform {
+  // Hardware spin locks are the only locks which work across both cores
+  // without relying on the SDK's mutex support.
+  class Lock {
+   public:
+    Lock() : lock_(spin_lock_instance(spin_lock_claim_unused(true))) {}
+    void lock() { saved_irq_ = spin_lock_blocking(lock_); }
+    void unlock() { spin_unlock(lock_, saved_irq_); }
+
+   private:
+    spin_lock_t* lock_;
+    std::uint32_t saved_irq_;
+  };
+
+  static int CurrentCore() { return get_core_num(); }
+  static void Wake() { __sev(); }
+  static void Wait(int) { __wfe(); }
+};
+
+using Executor = WorkStealingExecutor<Platform>;
+
+// Set by ExecutorInit(), after which point it is unchanged.
+Executor* executor = nullptr;
+
+// The default core 1 stack is only 2KiB, which is too small for the solver
+// kernels (day06 keeps an 8KiB visited set on the stack).
+constexpr int kCore1StackSize = 16 * 1024;
+std::uint32_t core1_stack[kCore1StackSize / sizeof(std::uint32_t)];
+
+}  // namespace
+
+void ExecutorInit() {
+  assert(!executor);
+  // Constructed here rather than statically so that the spin locks are claimed
+  // after the SDK has been initialised.
+  static Executor instance;
+  executor = &instance;
+  // Core 1 runs from flash, so it has to be paused while the answer cache is
+  // written to flash.
+  multicore_launch_core1_with_stack(
+      [] {
+        multicore_lockout_victim_init();
+        executor->Work(1);
+      },
+      core1_stack, sizeof(core1_stack));
+}
+
+void RunParallel(int begin, int end, void* data, ChunkFunction func) {
+  if (!executor) {
+    if (begin < end) func(data, 0, begin, end);
+    return;
+  }
+  executor->Run(begin, end, data, func);
+}
+
+}  // namespace aoc2024
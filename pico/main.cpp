@@ -1,11 +1,9 @@
 #include "../common/coro.hpp"
-#include "schedule.hpp"
-#include "solve.hpp"
-#include "tcp.hpp"
+#include "../common/parallel.hpp"
+#include "../common/schedule.hpp"
+#include "../server/serve.hpp"
 #include "wifi.hpp"
 
-#include <algorithm>
-#include <chrono>
 #include <pico/stdlib.h>
 #include <pico/cyw43_arch.h>
 #include <print>
@@ -19,6 +17,7 @@ bool Init() {
   if (!stdio_init_all()) return false;
   if (cyw43_arch_init_with_country(WIFI_COUNTRY) != 0) return false;
   if (!SchedulerInit()) return false;
+  ExecutorInit();
   return true;
 }
 
@@ -32,48 +31,23 @@ void ConnectToWifi() {
   std::println("Connected.");
 }
 
-Task<void> Serve() {
-  std::println("Serve");
-  tcp::Acceptor acceptor(0xA0C);
-  std::println("Opened acceptor");
-
-  while (true) {
-    std::println("Waiting for connection...");
-    tcp::Socket socket = co_await acceptor.Accept();
-    SetLed(true);
-    char buffer[3];
-    std::span<const char> header = co_await socket.Read(buffer);
-    if (header.size() != 3 ||
-        !('0' <= header[0] && header[0] <= '9') ||
-        !('0' <= header[1] && header[1] <= '9') ||
-        header[2] != '\n') {
-      co_await socket.Write("bad header\n");
-      continue;
-    }
-    const int day = 10 * (header[0] - '0') + (header[1] - '0');
-    if (!(1 <= day && day <= 25)) {
-      co_await socket.Write("bad day\n");
-      continue;
-    }
-    std::println("Solving day {}...", day);
-    using Clock = std::chrono::steady_clock;
-    using Time = Clock::time_point;
-    using std::chrono_literals::operator""us;
-    const Time start = Clock::now();
-    co_await Solve(day, socket);
-    const Time end = Clock::now();
-    std::println("Solved in {}us", (end - start) / 1us);
-    SetLed(false);
-  }
-}
-
 void Run() {
   if (!Init()) std::exit(1);
   SetLed(true);
   ConnectToWifi();
   SetLed(false);
 
-  Task<void> server = Serve();
+  // Everything here comes out of the same 264KiB of SRAM as the heap, which
+  // the largest solution frames (such as day 12's, at around 178KB) need.
+  const ServeOptions options = {
+      .max_connections = 2,
+      .frame_arena_size = 24 * 1024,
+      .request_block_size = 8 * 1024,
+      // Still larger than lwIP's receive window (TCP_WND in lwipopts.h).
+      .read_ahead_size = 4 * 1024,
+      .set_busy = SetLed,
+  };
+  Task<void> server = Serve(options);
   server.Start([] {
     std::println("Stopped serving.");
     std::exit(1);
@@ -0,0 +1,36 @@
+#include "../common/memory.hpp"
+
+#include <cstdlib>
+#include <malloc.h>
+#include <new>
+
+// Defined by the pico-sdk linker script. Core 0's stack is at the top of the
+// SCRATCH_Y bank and the heap fills the rest of the RAM after the static data.
+extern "C" std::byte __StackBottom, __end__, __HeapLimit;
+
+namespace aoc2024 {
+namespace {
+
+// Left to newlib's malloc, which the C library still uses (such as for the
+// buffers of stdio).
+constexpr std::size_t kMallocReserve = 8 * 1024;
+
+}  // namespace
+
+// Solutions run on core 0, either from `main` or from the interrupt which
+// services lwIP, and both of those share the main stack.
+std::byte* StackLimit() { return &__StackBottom; }
+
+// The pool is a single block from newlib's heap which takes all of it apart
+// from `kMallocReserve`.
+std::span<std::byte> HeapPool() {
+  const std::size_t size = &__HeapLimit - &__end__;
+  const std::size_t in_use = mallinfo().uordblks;
+  if (size < in_use + kMallocReserve) throw std::bad_alloc();
+  const std::size_t pool_size = size - in_use - kMallocReserve;
+  void* pool = std::malloc(pool_size);
+  if (!pool) throw std::bad_alloc();
+  return std::span(static_cast<std::byte*>(pool), pool_size);
+}
+
+}  // namespace aoc2024
@@ -1,6 +1,9 @@
-#include "schedule.hpp"
+#include "../common/schedule.hpp"
+
+#include "../common/frame_arena.hpp"
 
 #include <pico/cyw43_arch.h>
+#include <utility>
 
 namespace aoc2024 {
 namespace {
@@ -10,13 +13,20 @@ async_when_pending_worker worker;
 
 BackgroundTask* head;
 BackgroundTask* tail;
+SchedulerStats stats;
 
+// Runs the tasks which were queued when the worker was called. Anything they
+// schedule marks the worker as pending again, so the async context gets to run
+// its other workers and timers (which drive cyw43 and lwIP) before a coroutine
+// which yields (see `MaybeYield()`) resumes.
 void Run() {
-  while (head) {
-    BackgroundTask* task = head;
-    head = head->next;
-    if (!head) tail = nullptr;
+  BackgroundTask* task = std::exchange(head, nullptr);
+  tail = nullptr;
+  while (task) {
+    // The task may be destroyed or rescheduled once it has run.
+    BackgroundTask* const next = task->next;
     task->func(task->data);
+    task = next;
   }
 }
 
@@ -29,9 +39,20 @@ bool SchedulerInit() {
   return true;
 }
 
+SchedulerStats GetSchedulerStats() {
+  SchedulerStats result = stats;
+  result.frames_allocated = FrameArena::heap_frames();
+  return result;
+}
+
+void CountAllocatedTask() { stats.allocated++; }
+
 void BackgroundTask::Schedule() {
+  stats.scheduled++;
+  next = nullptr;
   if (tail) {
     tail->next = this;
+    tail = this;
   } else {
     head = tail = this;
     async_context_set_work_pending(cyw43_arch_async_context(), &worker);
@@ -1,6 +1,6 @@
 #include "tcp.hpp"
 
-#include "schedule.hpp"
+#include "../common/schedule.hpp"
 
 #include <print>
 
@@ -21,6 +21,7 @@ Socket::Socket(Socket&& other) noexcept
     : handle_(std::move(other.handle_)),
       received_(std::move(other.received_)),
       pending_read_(std::exchange(other.pending_read_, nullptr)),
+      pending_receive_(std::exchange(other.pending_receive_, nullptr)),
       pending_write_(std::exchange(other.pending_write_, nullptr)),
       send_eof_(std::exchange(other.send_eof_, true)),
       receive_eof_(std::exchange(other.receive_eof_, true)) {
@@ -31,6 +32,7 @@ Socket& Socket::operator=(Socket&& other) noexcept {
   handle_ = std::move(other.handle_);
   received_ = std::move(other.received_);
   pending_read_ = std::exchange(other.pending_read_, nullptr);
+  pending_receive_ = std::exchange(other.pending_receive_, nullptr);
   pending_write_ = std::exchange(other.pending_write_, nullptr);
   send_eof_ = std::exchange(other.send_eof_, true);
   receive_eof_ = std::exchange(other.receive_eof_, true);
@@ -40,7 +42,24 @@ Socket& Socket::operator=(Socket&& other) noexcept {
 
 Socket::ReadAwaitable Socket::Read(std::span<char> buffer) {
   assert(handle_);
-  return ReadAwaitable(*this, buffer);
+  return ReadAwaitable(*this, buffer, false);
+}
+
+Socket::ReadAwaitable Socket::ReadChunk(std::span<char> buffer) {
+  assert(handle_);
+  return ReadAwaitable(*this, buffer, true);
+}
+
+Socket::ReceiveAwaitable Socket::Receive(std::size_t min_bytes) {
+  assert(handle_);
+  return ReceiveAwaitable(*this, min_bytes);
+}
+
+void Socket::Consume(std::size_t n) {
+  if (n == 0) return;
+  assert(received_ && n <= received_->tot_len);
+  received_ = Buffer(pbuf_free_header(received_.release(), n));
+  tcp_recved(handle_.get(), n);
 }
 
 Socket::WriteAwaitable Socket::Write(std::span<const char> bytes) {
@@ -77,6 +96,9 @@ void Socket::OnReceived(Buffer data) {
     receive_eof_ = true;
   }
   if (pending_read_) ReadData();
+  if (pending_receive_ && HasReceived(pending_receive_->min_bytes_)) {
+    pending_receive_->Done();
+  }
 }
 
 void Socket::ReadData() {
@@ -96,6 +118,19 @@ void Socket::ReadData() {
   if (!received_ && pending_read_ && receive_eof_) pending_read_->Done();
 }
 
+bool Socket::HasReceived(std::size_t min_bytes) const {
+  return receive_eof_ || (received_ && received_->tot_len >= min_bytes);
+}
+
+std::span<const std::string_view> Socket::Segments() {
+  int n = 0;
+  for (const pbuf* p = received_.get(); p && n < kMaxSegments; p = p->next) {
+    segments_[n++] = std::string_view(static_cast<const char*>(p->payload),
+                                      p->len);
+  }
+  return std::span<const std::string_view>(segments_, n);
+}
+
 void Socket::SetCallbacks() {
   if (!handle_) return;
   tcp_arg(handle_.get(), this);
@@ -118,8 +153,10 @@ void Socket::SetCallbacks() {
     // When the error callback is invoked, the PCB has already been freed.
     (void)socket.handle_.release();
     ReadAwaitable* const read = socket.pending_read_;
+    ReceiveAwaitable* const receive = socket.pending_receive_;
     WriteAwaitable* const write = socket.pending_write_;
     if (read) read->Fail(error);
+    if (receive) receive->Fail(error);
     if (write) write->Fail(error);
   });
 }
@@ -131,13 +168,13 @@ void Socket::UnsetCallbacks() {
   tcp_err(handle_.get(), nullptr);
 }
 
-Acceptor::Acceptor(int port) {
+Acceptor::Acceptor(int port, int backlog) : backlog_(backlog) {
   handle_ = Handle(tcp_new_ip_type(IPADDR_TYPE_V4));
   if (!handle_) throw AcceptorError("Failed to create acceptor socket.");
   if (err_t error = tcp_bind(handle_.get(), nullptr, port); error != ERR_OK) {
     throw AcceptorError("Failed to bind to serving port.");
   }
-  handle_ = Handle(tcp_listen_with_backlog(handle_.release(), 1));
+  handle_ = Handle(tcp_listen_with_backlog(handle_.release(), backlog));
   if (!handle_) throw AcceptorError("Failed to listen for connections.");
 
   SetCallbacks();
@@ -149,12 +186,16 @@ Acceptor::~Acceptor() {
 }
 
 Acceptor::Acceptor(Acceptor&& other) noexcept
-    : handle_(std::move(other.handle_)) {
+    : handle_(std::move(other.handle_)),
+      queued_(std::move(other.queued_)),
+      backlog_(other.backlog_) {
   SetCallbacks();
 }
 
 Acceptor& Acceptor::operator=(Acceptor&& other) noexcept {
   handle_ = std::move(other.handle_);
+  queued_ = std::move(other.queued_);
+  backlog_ = other.backlog_;
   SetCallbacks();
   return *this;
 }
@@ -171,8 +212,12 @@ void Acceptor::SetCallbacks() {
              [](void* self, tcp_pcb* client, err_t error) -> err_t {
                Acceptor& acceptor = *reinterpret_cast<Acceptor*>(self);
                assert(client || error != ERR_OK);
-               acceptor.OnAccept(Socket::Handle(client), error);
-               return ERR_OK;
+               Socket::Handle handle(client);
+               if (acceptor.OnAccept(handle, error)) return ERR_OK;
+               // lwIP still uses the pcb after this callback returns unless
+               // it is told that the pcb has been aborted.
+               tcp_abort(handle.release());
+               return ERR_ABRT;
              });
 }
 
@@ -182,19 +227,25 @@ void Acceptor::UnsetCallbacks() {
   tcp_accept(handle_.get(), nullptr);
 }
 
-void Acceptor::OnAccept(Socket::Handle client, err_t error) {
+bool Acceptor::OnAccept(Socket::Handle& client, err_t error) {
   if (!pending_accept_) {
     if (error) {
       std::println("Ignoring accept error {} with no pending accept call.",
                    error);
+    } else if (int(queued_.size()) < backlog_) {
+      queued_.push_back(Socket(std::move(client)));
+    } else {
+      std::println("Refusing connection: backlog is full.");
+      return false;
     }
-    return;
+    return true;
   }
   if (client) {
     pending_accept_->Resolve(std::move(client));
   } else {
     pending_accept_->Fail(error);
   }
+  return true;
 }
 
 bool Socket::ReadAwaitable::await_ready() const { return false; }
@@ -218,13 +269,13 @@ std::span<char> Socket::ReadAwaitable::unused() const {
 void Socket::ReadAwaitable::Done() {
   assert(socket_.pending_read_ == this);
   socket_.pending_read_ = nullptr;
-  Schedule(awaiter_);
+  Schedule(resume_, awaiter_);
 }
 
 void Socket::ReadAwaitable::Received(int n) {
   assert(num_bytes_ + n <= int(buffer_.size()));
   num_bytes_ += n;
-  if (num_bytes_ == int(buffer_.size())) Done();
+  if (chunk_ || num_bytes_ == int(buffer_.size())) Done();
 }
 
 void Socket::ReadAwaitable::Fail(err_t error) {
@@ -232,6 +283,32 @@ void Socket::ReadAwaitable::Fail(err_t error) {
   Done();
 }
 
+bool Socket::ReceiveAwaitable::await_ready() const {
+  return socket_.HasReceived(min_bytes_);
+}
+
+void Socket::ReceiveAwaitable::await_suspend(std::coroutine_handle<> awaiter) {
+  awaiter_ = awaiter;
+  assert(!socket_.pending_receive_);
+  socket_.pending_receive_ = this;
+}
+
+std::span<const std::string_view> Socket::ReceiveAwaitable::await_resume() {
+  if (error_ != ERR_OK) throw SocketError("Receive error");
+  return socket_.Segments();
+}
+
+void Socket::ReceiveAwaitable::Done() {
+  assert(socket_.pending_receive_ == this);
+  socket_.pending_receive_ = nullptr;
+  Schedule(resume_, awaiter_);
+}
+
+void Socket::ReceiveAwaitable::Fail(err_t error) {
+  error_ = error;
+  Done();
+}
+
 bool Socket::WriteAwaitable::await_ready() const { return bytes_.empty(); }
 
 void Socket::WriteAwaitable::await_suspend(std::coroutine_handle<> awaiter) {
@@ -255,17 +332,14 @@ void Socket::WriteAwaitable::WriteSome() {
   const err_t error =
       tcp_write(socket_.handle_.get(), to_send.data(), to_send.size(),
                 to_send.size() < remaining.size() ? TCP_WRITE_FLAG_MORE : 0);
-  if (error == ERR_OK) {
-    error_ = error;
-    return Done();
-  }
+  if (error != ERR_OK) return Fail(error);
   sent_ += to_send.size();
 }
 
 void Socket::WriteAwaitable::Done() {
   assert(socket_.pending_write_ == this);
   socket_.pending_write_ = nullptr;
-  Schedule(awaiter_);
+  Schedule(resume_, awaiter_);
 }
 
 void Socket::WriteAwaitable::Sent(int n) {
@@ -280,7 +354,9 @@ void Socket::WriteAwaitable::Fail(err_t error) {
   Done();
 }
 
-bool Acceptor::AcceptAwaitable::await_ready() const { return false; }
+bool Acceptor::AcceptAwaitable::await_ready() const {
+  return !acceptor_.queued_.empty();
+}
 
 void Acceptor::AcceptAwaitable::await_suspend(std::coroutine_handle<> awaiter) {
   awaiter_ = awaiter;
@@ -289,6 +365,12 @@ void Acceptor::AcceptAwaitable::await_suspend(std::coroutine_handle<> awaiter) {
 }
 
 Socket Acceptor::AcceptAwaitable::await_resume() {
+  if (!awaiter_) {
+    // The connection was already queued, so the coroutine never suspended.
+    Socket socket = std::move(acceptor_.queued_.front());
+    acceptor_.queued_.pop_front();
+    return socket;
+  }
   if (result_) {
     return std::move(*result_);
   } else {
@@ -299,7 +381,7 @@ Socket Acceptor::AcceptAwaitable::await_resume() {
 void Acceptor::AcceptAwaitable::Done() {
   assert(acceptor_.pending_accept_ == this);
   acceptor_.pending_accept_ = nullptr;
-  Schedule(awaiter_);
+  Schedule(resume_, awaiter_);
 }
 
 void Acceptor::AcceptAwaitable::Resolve(Socket::Handle handle) {
@@ -3,12 +3,16 @@
 
 #include "../common/coro.hpp"
 #include "../common/delete_with.hpp"
+#include "../common/schedule.hpp"
 
+#include <deque>
 #include <expected>
 #include <lwip/tcp.h>
 #include <memory>
 #include <pico/async_context.h>
+#include <span>
 #include <stdexcept>
+#include <string_view>
 
 namespace aoc2024::tcp {
 
@@ -35,6 +39,26 @@ class Socket {
   class ReadAwaitable;
   ReadAwaitable Read(std::span<char> buffer);
 
+  // Like `Read`, but completes as soon as any bytes are available instead of
+  // waiting for the buffer to be full. An empty span indicates that the peer
+  // has closed the socket for sending.
+  ReadAwaitable ReadChunk(std::span<char> buffer);
+
+  // Waits until at least `min_bytes` bytes have been received and not yet
+  // consumed, or until the peer has closed the socket for sending. The
+  // awaitable yields a view of the unconsumed bytes which refers directly to
+  // the pbuf chain, so nothing is copied. The view remains valid until the next
+  // call to `Consume`. If fewer than `min_bytes` bytes are yielded, the peer
+  // has closed the socket for sending. At most `kMaxSegments` segments are
+  // yielded at a time, so `min_bytes` should be small (around one record).
+  static constexpr int kMaxSegments = 16;
+  class ReceiveAwaitable;
+  ReceiveAwaitable Receive(std::size_t min_bytes);
+
+  // Releases the first `n` bytes yielded by `Receive`, which advances the
+  // receive window.
+  void Consume(std::size_t n);
+
   // Writes the given bytes to the socket. On error, an exception is thrown.
   class WriteAwaitable;
   WriteAwaitable Write(std::span<const char> bytes);
@@ -53,6 +77,8 @@ class Socket {
   void OnSent(u16_t bytes);
   void OnReceived(Buffer data);
   void ReadData();
+  bool HasReceived(std::size_t min_bytes) const;
+  std::span<const std::string_view> Segments();
 
   void SetCallbacks();
   void UnsetCallbacks();
@@ -63,6 +89,10 @@ class Socket {
   Buffer received_;
   // A pending read which has not yet received as much data as it requested.
   ReadAwaitable* pending_read_ = nullptr;
+  // A pending receive which has not yet received as much data as it requested.
+  ReceiveAwaitable* pending_receive_ = nullptr;
+  // Views of the segments in `received_`, as yielded by `Receive`.
+  std::string_view segments_[kMaxSegments];
   // A pending write which has not yet sent as much data as it needs to.
   WriteAwaitable* pending_write_ = nullptr;
 
@@ -70,11 +100,12 @@ class Socket {
   bool receive_eof_ = false;
 };
 
-// Listens on a port and accepts incoming connections.
-// Neither threadsafe nor reentrant.
+// Listens on a port and accepts incoming connections. Up to `backlog`
+// connections which arrive while nobody is waiting in `Accept` are queued and
+// handed out in the order they arrived. Neither threadsafe nor reentrant.
 class Acceptor {
  public:
-  explicit Acceptor(int port);
+  explicit Acceptor(int port, int backlog = 1);
   ~Acceptor();
 
   // Not copyable.
@@ -97,10 +128,17 @@ class Acceptor {
   void SetCallbacks();
   void UnsetCallbacks();
 
-  void OnAccept(Socket::Handle client, err_t error);
+  // Takes `client` (by moving from it) and returns true, unless the backlog
+  // is full. A refused client is left for the caller, which has to abort it
+  // in a way that lwIP expects.
+  bool OnAccept(Socket::Handle& client, err_t error);
 
   Handle handle_;
   AcceptAwaitable* pending_accept_ = nullptr;
+  // Connections which arrived while there was no pending accept. These are
+  // wrapped in sockets straight away so that no received data is dropped.
+  std::deque<Socket> queued_;
+  int backlog_;
 };
 
 class Error : public std::exception {
@@ -134,8 +172,8 @@ class [[nodiscard]] Socket::ReadAwaitable {
  private:
   friend class Socket;
 
-  explicit ReadAwaitable(Socket& socket, std::span<char> buffer)
-      : socket_(socket), buffer_(buffer) {}
+  explicit ReadAwaitable(Socket& socket, std::span<char> buffer, bool chunk)
+      : socket_(socket), buffer_(buffer), chunk_(chunk) {}
 
   std::span<char> unused() const;
 
@@ -145,9 +183,34 @@ class [[nodiscard]] Socket::ReadAwaitable {
 
   Socket& socket_;
   std::span<char> buffer_;
+  // If true, the read completes as soon as any bytes have been received.
+  bool chunk_;
   int num_bytes_ = 0;
   err_t error_ = ERR_OK;
   std::coroutine_handle<> awaiter_;
+  BackgroundTask resume_;
+};
+
+class [[nodiscard]] Socket::ReceiveAwaitable {
+ public:
+  bool await_ready() const;
+  void await_suspend(std::coroutine_handle<> awaiter);
+  std::span<const std::string_view> await_resume();
+
+ private:
+  friend class Socket;
+
+  explicit ReceiveAwaitable(Socket& socket, std::size_t min_bytes)
+      : socket_(socket), min_bytes_(min_bytes) {}
+
+  void Done();
+  void Fail(err_t error);
+
+  Socket& socket_;
+  std::size_t min_bytes_;
+  err_t error_ = ERR_OK;
+  std::coroutine_handle<> awaiter_;
+  BackgroundTask resume_;
 };
 
 class [[nodiscard]] Socket::WriteAwaitable {
@@ -175,6 +238,7 @@ class [[nodiscard]] Socket::WriteAwaitable {
   int sent_ = 0, acked_ = 0;
   err_t error_ = ERR_OK;
   std::coroutine_handle<> awaiter_;
+  BackgroundTask resume_;
   async_when_pending_worker_t worker_;
 };
 
@@ -196,6 +260,7 @@ class [[nodiscard]] Acceptor::AcceptAwaitable {
   Acceptor& acceptor_;
   std::expected<Socket, err_t> result_;
   std::coroutine_handle<> awaiter_;
+  BackgroundTask resume_;
   async_when_pending_worker_t worker_;
 };
 
@@ -1,4 +1,8 @@
 #!/bin/bash
+#
+# Usage: solve.sh DAY|all [PICO]
+#
+# With `all`, every day which has an input is solved over a single connection.
 
 day="${1?}"
 
@@ -6,6 +10,13 @@ if [[ -z "$PICO" ]]; then
   PICO="${2?}"
 fi
 
-input="$(printf "puzzles/day%02d.input" "$day")"
+# The client is built as part of the host build (see README.md).
+client="${AOC_CLIENT:-build-host/host/aoc_client}"
 
-(echo "$(printf "%02d\n" "$day")"; cat "$input") | ncat "$PICO" 2572
+# Set AOC_LOG to append each response to a log for aoc_trace.
+if [[ "$day" == all ]]; then
+  "$client" ${AOC_LOG:+--log="$AOC_LOG"} --puzzles=puzzles "$PICO" all
+else
+  input="$(printf "puzzles/day%02d.input" "$day")"
+  "$client" ${AOC_LOG:+--log="$AOC_LOG"} "$PICO" "$day" < "$input"
+fi
@@ -0,0 +1,510 @@
+#include "serve.hpp"
+
+#include "../common/answer_cache.hpp"
+#include "../common/api.hpp"
+#include "../common/frame_arena.hpp"
+#include "../common/memory.hpp"
+#include "../common/request_arena.hpp"
+#include "../common/schedule.hpp"
+#include "../common/semaphore.hpp"
+#include "../common/stream.hpp"
+#include "solve.hpp"
+#include "tcp.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <print>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace aoc2024 {
+namespace {
+
+void PrintEvents(const Response& response) {
+  std::span<const char> bytes = response.bytes();
+  while (!bytes.empty()) {
+    const ResponsePacket packet = ResponsePacket::Decode(bytes);
+    if (packet.type != ResponsePacketType::kEvent) continue;
+    if (packet.event == Event::kSpan) {
+      std::println("  {:{}}{}: {}us (at {}us)", "", 2 * packet.depth,
+                   packet.label, packet.duration.count(), packet.time.count());
+    } else if (packet.event == Event::kMemory) {
+      std::println("  {}", FormatMemoryUsage(packet.memory));
+    } else {
+      std::println("  {}: {}us", EventName(packet.event), packet.time.count());
+    }
+  }
+}
+
+// The text of the kOutput packets in the response, which is the answer.
+std::string Answer(const Response& response) {
+  std::string answer;
+  std::span<const char> bytes = response.bytes();
+  while (!bytes.empty()) {
+    const ResponsePacket packet = ResponsePacket::Decode(bytes);
+    if (packet.type == ResponsePacketType::kOutput) answer += packet.text;
+  }
+  return answer;
+}
+
+// Reads the requests on a connection, and serves as the stream for the input
+// of the current one. As soon as that input has all been read, the next
+// request's header and as much of its input as fits in the buffer are read in
+// the background. The client can then keep sending (and, on the Pico, lwIP's
+// small receive window keeps draining) while the current request is solved.
+class RequestReader {
+ public:
+  // Starts reading the first request.
+  RequestReader(tcp::Socket& socket, std::span<char> buffer)
+      : socket_(socket), buffer_(buffer) {
+    StartReadAhead();
+  }
+
+  // Not copyable.
+  RequestReader(const RequestReader&) = delete;
+  RequestReader& operator=(const RequestReader&) = delete;
+
+  // Waits for the next request and makes its input the contents of the
+  // stream. Yields false once the client has closed its side of the
+  // connection. Throws if the connection fails, or if it ends part way
+  // through a header. The previous input must have been read in full.
+  Task<bool> Next() {
+    assert(remaining_ == 0);
+    co_await Finish();
+    if (error_) std::rethrow_exception(error_);
+    if (next_header_size_ == 0) co_return false;
+    if (next_header_size_ < RequestHeader::kNumBytes) {
+      throw std::runtime_error("request header ended early");
+    }
+    std::ranges::copy(next_header_, header_);
+    remaining_ = RequestHeader::DecodeInputSize(next_header_);
+    if (remaining_ == 0) StartReadAhead();
+    co_return true;
+  }
+
+  // Decodes the current request's header. If it is bad, this throws but the
+  // input can still be skipped.
+  RequestHeader header() const {
+    return RequestHeader::Decode(
+        std::span<const char, RequestHeader::kNumBytes>(header_));
+  }
+
+  Task<std::span<char>> Read(std::span<char> buffer) {
+    buffer = buffer.first(std::min(buffer.size(), remaining_));
+    std::size_t n = TakeBuffered(buffer);
+    if (n < buffer.size()) {
+      n += (co_await socket_.Read(buffer.subspan(n))).size();
+    }
+    Advance(n);
+    co_return buffer.first(n);
+  }
+
+  Task<std::span<char>> ReadChunk(std::span<char> buffer) {
+    buffer = buffer.first(std::min(buffer.size(), remaining_));
+    std::size_t n = TakeBuffered(buffer);
+    if (n == 0 && !buffer.empty()) {
+      n = (co_await socket_.ReadChunk(buffer)).size();
+    }
+    Advance(n);
+    co_return buffer.first(n);
+  }
+
+  // The buffered bytes come first. As with `LimitedStream`, the socket may
+  // already have received bytes beyond the input, so they are hidden.
+  Task<std::span<const std::string_view>> Receive(std::size_t min_bytes) {
+    segments_.clear();
+    if (remaining_ == 0) co_return segments_;
+    min_bytes = std::min(min_bytes, remaining_);
+    std::size_t size = buffered_.size();
+    if (size > 0) {
+      segments_.emplace_back(buffered_.data(), size);
+      if (size >= min_bytes) co_return segments_;
+    }
+    for (std::string_view segment :
+         co_await socket_.Receive(min_bytes - size)) {
+      if (size == remaining_) break;
+      segment = segment.substr(0, remaining_ - size);
+      segments_.push_back(segment);
+      size += segment.size();
+    }
+    co_return segments_;
+  }
+
+  void Consume(std::size_t n) {
+    assert(n <= remaining_);
+    const std::size_t from_buffer = std::min(n, buffered_.size());
+    buffered_ = buffered_.subspan(from_buffer);
+    if (n > from_buffer) socket_.Consume(n - from_buffer);
+    Advance(n);
+  }
+
+  auto Write(std::span<const char> bytes) { return socket_.Write(bytes); }
+
+  // Reads and discards whatever is left of the input, such as when a solution
+  // fails before reading all of it. Throws if the connection ends first.
+  Task<void> Skip() {
+    char buffer[256];
+    while (remaining_ > 0) {
+      const std::span<char> chunk = co_await ReadChunk(buffer);
+      if (chunk.empty()) throw std::runtime_error("input ended early");
+    }
+  }
+
+  // The number of bytes of the input which have not yet been read or
+  // consumed.
+  std::size_t remaining() const { return remaining_; }
+
+  // Waits for any read ahead to finish. This must be called before the reader
+  // is destroyed.
+  Task<void> Finish() {
+    if (!reading_) co_return;
+    co_await idle_.Acquire();
+    reading_ = false;
+  }
+
+ private:
+  // Copies as many buffered bytes as fit into `buffer`.
+  std::size_t TakeBuffered(std::span<char> buffer) {
+    const std::size_t n = std::min(buffer.size(), buffered_.size());
+    std::ranges::copy(buffered_.first(n), buffer.begin());
+    buffered_ = buffered_.subspan(n);
+    return n;
+  }
+
+  // Accounts for `n` bytes of the input, and starts reading the next request
+  // once there are none left.
+  void Advance(std::size_t n) {
+    if (n == 0) return;
+    remaining_ -= n;
+    if (remaining_ == 0) StartReadAhead();
+  }
+
+  void StartReadAhead() {
+    reading_ = true;
+    // The previous read ahead has finished, so it is safe to replace.
+    read_ahead_.emplace(ReadAheadCatching());
+    read_ahead_->Start([this] { idle_.Release(); });
+  }
+
+  // The input of the current request has all been read by now, so the buffer
+  // is free.
+  Task<void> ReadAheadCatching() {
+    try {
+      next_header_size_ = (co_await socket_.Read(next_header_)).size();
+      if (next_header_size_ < RequestHeader::kNumBytes) co_return;
+      const std::size_t size = std::min<std::size_t>(
+          buffer_.size(), RequestHeader::DecodeInputSize(next_header_));
+      buffered_ = co_await socket_.Read(buffer_.first(size));
+    } catch (const std::exception&) {
+      error_ = std::current_exception();
+    }
+  }
+
+  tcp::Socket& socket_;
+  std::span<char> buffer_;
+  // The part of `buffer_` which holds input that has not been read yet.
+  std::span<const char> buffered_;
+  char header_[RequestHeader::kNumBytes] = {};
+  char next_header_[RequestHeader::kNumBytes];
+  std::size_t next_header_size_ = 0;
+  std::size_t remaining_ = 0;
+  std::vector<std::string_view> segments_;
+  // Released when a read ahead finishes.
+  Semaphore idle_{0};
+  bool reading_ = false;
+  std::optional<Task<void>> read_ahead_;
+  std::exception_ptr error_;
+};
+
+static_assert(ByteStream<RequestReader>);
+
+// Answers a single request, recording the answer, the timing of each phase and
+// the peak memory usage in `response`. Inputs which have been seen before are
+// answered from the cache without being parsed at all. Everything which the
+// solution allocates from `scratch` (via `response.memory()`) is freed
+// afterwards.
+Task<void> HandleRequest(const RequestHeader& header,
+                         RequestReader& input, Response& response,
+                         FrameArena& arena, RequestArena& scratch,
+                         AnswerCache& cache) {
+  const int day = header.day;
+  HashingStream hashed(input);
+  if (cache.Find(day, header.input_hash)) {
+    // The input still has to be read to reach the next request, and hashing
+    // it checks that the client's hash was right.
+    co_await Discard(hashed);
+    if (hashed.hash() != header.input_hash) {
+      throw std::runtime_error("input does not match its hash");
+    }
+    // Another connection may have changed the cache in the meantime.
+    const std::optional<std::string_view> answer =
+        cache.Find(day, header.input_hash);
+    if (!answer) throw std::runtime_error("cached answer was evicted");
+    std::println("Day {} was cached", day);
+    response.Print("{}", *answer);
+    response.RecordEvent(Event::kDone);
+    co_return;
+  }
+
+  std::println("Solving day {}...", day);
+  using Clock = std::chrono::steady_clock;
+  using Time = Clock::time_point;
+  using std::chrono_literals::operator""us;
+  const Time start = Clock::now();
+  Stream stream(hashed);
+  const MemoryWatermark watermark;
+  // Declared before the task so that the scratch memory is only freed after
+  // the solution's frame (and any containers in it) has been destroyed.
+  struct ResetScratch {
+    ~ResetScratch() { scratch.Reset(); }
+    RequestArena& scratch;
+  } reset_scratch{scratch};
+  Task<void> solve = Solve(day, stream, response, arena);
+  std::println("Day {} frame is {} bytes ({})", day, arena.last_frame_size(),
+               arena.used() ? "arena" : "heap");
+  co_await solve;
+  const Time end = Clock::now();
+  std::println("Solved day {} in {}us", day, (end - start) / 1us);
+  response.RecordMemory(watermark.Measure());
+  const SchedulerStats stats = GetSchedulerStats();
+  std::println("Scheduled {} tasks ({} allocated), {} frames on the heap",
+               stats.scheduled, stats.allocated, stats.frames_allocated);
+
+  // The answer is cached under the hash of the whole input, including any of
+  // it which the solution didn't need to read.
+  co_await Discard(hashed);
+  const std::string answer = Answer(response);
+  if (input.remaining() > 0 || answer.empty()) co_return;
+  try {
+    cache.Insert(day, hashed.hash(), answer);
+  } catch (const std::exception& e) {
+    std::println("Failed to cache the answer: {}", e.what());
+  }
+}
+
+// Sends responses in the background, so that the next request on the
+// connection can be read and solved while the previous response is still in
+// flight (on the Pico, a write only completes once the client acknowledges
+// it). Responses are double buffered: one is built while the other is sent.
+class ResponseSender {
+ public:
+  static constexpr int kBufferSize = kResponseBufferSize;
+
+  explicit ResponseSender(tcp::Socket& socket) : socket_(socket) {}
+
+  // Not copyable.
+  ResponseSender(const ResponseSender&) = delete;
+  ResponseSender& operator=(const ResponseSender&) = delete;
+
+  // The buffer for the next response, which is not in use by any send.
+  std::span<char> buffer() { return buffers_[next_]; }
+
+  // Waits for the previous response to be sent, and then starts sending the
+  // first `size` bytes of `buffer()`. Throws if the previous send failed.
+  Task<void> Send(std::size_t size) {
+    co_await idle_.Acquire();
+    if (error_) {
+      idle_.Release();
+      std::rethrow_exception(error_);
+    }
+    // The previous task has finished, so it is safe to replace.
+    sending_.emplace(SendCatching(buffer().first(size)));
+    next_ = 1 - next_;
+    sending_->Start([this] { idle_.Release(); });
+  }
+
+  // Waits until every response has been sent. Throws if any send failed. This
+  // must be called before the sender is destroyed.
+  Task<void> Flush() {
+    co_await idle_.Acquire();
+    idle_.Release();
+    if (error_) std::rethrow_exception(error_);
+  }
+
+ private:
+  Task<void> SendCatching(std::span<const char> bytes) {
+    try {
+      co_await socket_.Write(bytes);
+    } catch (const std::exception&) {
+      error_ = std::current_exception();
+    }
+  }
+
+  tcp::Socket& socket_;
+  char buffers_[2][kBufferSize];
+  int next_ = 0;
+  // Available while no response is being sent.
+  Semaphore idle_{1};
+  std::optional<Task<void>> sending_;
+  std::exception_ptr error_;
+};
+
+// Handles requests until the client closes its side of the connection. Each
+// response is sent once its request is finished, including any error as a
+// debug packet.
+Task<void> HandleRequests(RequestReader& reader, ResponseSender& sender,
+                          FrameArena& arena, RequestArena& scratch,
+                          AnswerCache& cache) {
+  while (co_await reader.Next()) {
+    // The response's clock starts now rather than while waiting for the
+    // client. A header which frames correctly but is otherwise bad fails just
+    // that request: its input is skipped all the same.
+    const std::span<char> buffer = sender.buffer();
+    Response response(buffer.subspan(ResponseHeader::kNumBytes), scratch);
+    try {
+      const RequestHeader header = reader.header();
+      response.RecordEvent(Event::kRequestParsed);
+      co_await HandleRequest(header, reader, response, arena, scratch, cache);
+    } catch (const std::exception& e) {
+      std::println("Request failed: {}", e.what());
+      response.Debug("{}", e.what());
+    }
+    // The next request starts straight after this one's input, but a solution
+    // which failed may not have read all of it.
+    co_await reader.Skip();
+    if (const int dropped = response.FlushSpans(); dropped > 0) {
+      std::println("Dropped {} trace spans", dropped);
+    }
+    PrintEvents(response);
+    const std::size_t size = response.bytes().size();
+    ResponseHeader{.size = std::uint16_t(size)}.EncodeTo(
+        buffer.first<ResponseHeader::kNumBytes>());
+    co_await sender.Send(ResponseHeader::kNumBytes + size);
+  }
+}
+
+Task<void> HandleConnection(tcp::Socket socket, std::span<char> read_ahead,
+                            FrameArena& arena, RequestArena& scratch,
+                            AnswerCache& cache) {
+  ResponseSender sender(socket);
+  RequestReader reader(socket, read_ahead);
+  std::exception_ptr error;
+  try {
+    co_await HandleRequests(reader, sender, arena, scratch, cache);
+  } catch (const std::exception&) {
+    error = std::current_exception();
+  }
+  // The next request may still be being read, and the last response may still
+  // be in flight. Both refer to `socket`.
+  co_await reader.Finish();
+  co_await sender.Flush();
+  if (error) std::rethrow_exception(error);
+}
+
+Task<void> HandleConnectionCatching(tcp::Socket socket,
+                                    std::span<char> read_ahead,
+                                    FrameArena& arena, RequestArena& scratch,
+                                    AnswerCache& cache) {
+  try {
+    co_await HandleConnection(std::move(socket), read_ahead, arena, scratch,
+                              cache);
+  } catch (const std::exception& e) {
+    std::println("Connection failed: {}", e.what());
+  }
+}
+
+class Server {
+ public:
+  explicit Server(const ServeOptions& options)
+      : options_(options),
+        acceptor_(options.port, options.max_connections),
+        slots_(options.max_connections),
+        connections_(options.max_connections) {
+    for (Connection& connection : connections_) {
+      connection.frames =
+          std::make_unique<std::byte[]>(options.frame_arena_size);
+      connection.arena.emplace(std::span(connection.frames.get(),
+                                         options.frame_arena_size));
+      connection.scratch.emplace(options.request_block_size);
+      connection.read_ahead =
+          std::make_unique<char[]>(options.read_ahead_size);
+    }
+  }
+
+  Task<void> Run() {
+    std::println("Opened acceptor");
+    while (true) {
+      co_await slots_.Acquire();
+      std::println("Waiting for connection...");
+      tcp::Socket socket = co_await acceptor_.Accept();
+      Connection& connection =
+          *std::ranges::find(connections_, false, &Connection::active);
+      connection.active = true;
+      if (num_active_++ == 0) SetBusy(true);
+      // Any previous task in this slot has finished, so it is safe to replace.
+      connection.task.emplace(
+          HandleConnectionCatching(std::move(socket),
+                                   std::span(connection.read_ahead.get(),
+                                             options_.read_ahead_size),
+                                   *connection.arena, *connection.scratch,
+                                   cache_));
+      connection.task->Start([this, &connection] {
+        connection.active = false;
+        if (--num_active_ == 0) {
+          SetBusy(false);
+          PersistCache();
+        }
+        slots_.Release();
+      });
+    }
+  }
+
+ private:
+  // A slot for a connection which is being handled. A task can't be destroyed
+  // from within its own completion callback, so finished tasks are only
+  // destroyed when their slot is reused. Each slot has its own arenas for the
+  // solution's frame and scratch memory, and its own read ahead buffer, which
+  // are reused by every request in that slot. The scratch arena only holds
+  // memory while a request is using it.
+  struct Connection {
+    std::unique_ptr<std::byte[]> frames;
+    std::optional<FrameArena> arena;
+    std::optional<RequestArena> scratch;
+    std::unique_ptr<char[]> read_ahead;
+    std::optional<Task<void>> task;
+    bool active = false;
+  };
+
+  void SetBusy(bool busy) {
+    if (options_.set_busy) options_.set_busy(busy);
+  }
+
+  // Answers are batched up while there are connections, since persisting them
+  // stalls the Pico for as long as it takes to erase a flash sector.
+  void PersistCache() {
+    try {
+      cache_.Persist();
+    } catch (const std::exception& e) {
+      std::println("Failed to persist the answer cache: {}", e.what());
+    }
+  }
+
+  ServeOptions options_;
+  tcp::Acceptor acceptor_;
+  // Limits the number of connections which are handled at once. Connections
+  // beyond that wait in the acceptor's backlog and are admitted in FIFO order.
+  Semaphore slots_;
+  std::vector<Connection> connections_;
+  int num_active_ = 0;
+  // Shared by every connection.
+  AnswerCache cache_;
+};
+
+}  // namespace
+
+Task<void> Serve(ServeOptions options) {
+  std::println("Serve");
+  Server server(options);
+  co_await server.Run();
+}
+
+}  // namespace aoc2024
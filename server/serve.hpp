@@ -0,0 +1,43 @@
+#ifndef AOC2024_SERVE_HPP_
+#define AOC2024_SERVE_HPP_
+
+#include "../common/coro.hpp"
+
+#include <cstddef>
+
+namespace aoc2024 {
+
+struct ServeOptions {
+  // TCP port to listen on.
+  int port = 0xA0C;
+  // The maximum number of connections which are handled concurrently. While
+  // one connection is being solved, the others can receive their input. Any
+  // further connections are queued and admitted in the order they arrived.
+  int max_connections = 2;
+  // The size of the arena which each connection's solution frame is allocated
+  // from. This covers most days: larger frames (days 5, 7, 11, 12 and 19)
+  // are allocated on the heap instead, which the Pico needs to keep free.
+  std::size_t frame_arena_size = 24 * 1024;
+  // The smallest block which each connection's `RequestArena` takes from the
+  // heap. The arena holds no memory between requests, and takes blocks only
+  // when a solution asks for scratch memory: day 22 needs 104KiB (which gets
+  // a block of its own), day 23 around 75KiB in small pieces and day 24 12KiB.
+  std::size_t request_block_size = 16 * 1024;
+  // The size of each connection's buffer for the start of the next request's
+  // input, which is read while the current request is being solved. This is
+  // most useful when it is larger than the TCP receive window.
+  std::size_t read_ahead_size = 8 * 1024;
+  // If set, this is invoked with `true` when the server becomes busy handling
+  // connections and with `false` once it is idle again. The Pico uses this to
+  // drive the LED.
+  void (*set_busy)(bool) = nullptr;
+};
+
+// Accepts connections forever, handling up to `max_connections` of them at
+// once. Each connection carries a stream of framed requests (see
+// `RequestHeader`), which are answered in order.
+Task<void> Serve(ServeOptions options);
+
+}  // namespace aoc2024
+
+#endif  // AOC2024_SERVE_HPP_
@@ -0,0 +1,19 @@
+#ifndef AOC2024_SOLVE_HPP_
+#define AOC2024_SOLVE_HPP_
+
+#include "../common/api.hpp"
+#include "../common/coro.hpp"
+#include "../common/frame_arena.hpp"
+#include "../common/stream.hpp"
+
+namespace aoc2024 {
+
+// Solves the given day, reading input from `stream` and writing the answer back
+// to it. Progress through the solution is recorded as events in `response`.
+// The solution's frame is allocated from `arena`, which must outlive the task.
+Task<void> Solve(int day, Stream& stream, Response& response,
+                 FrameArena& arena);
+
+}  // namespace aoc2024
+
+#endif  // AOC2024_SOLVE_HPP_
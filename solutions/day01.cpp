@@ -1,6 +1,8 @@
+#include "../common/api.hpp"
+#include "../common/buffered_reader.hpp"
 #include "../common/coro.hpp"
 #include "../common/scan.hpp"
-#include "tcp.hpp"
+#include "../common/stream.hpp"
 
 #include <algorithm>
 #include <print>
@@ -8,12 +10,13 @@
 namespace aoc2024 {
 
 struct Input {
-  Task<void> Read(tcp::Socket& socket) {
-    char buffer[14001];
-    std::string_view input(co_await socket.Read(buffer));
+  Task<void> Read(Stream& stream) {
+    char buffer[32];
+    BufferedReader reader(stream, buffer);
 
     for (int i = 0; i < 1000; i++) {
-      if (!ScanPrefix(input, "{}   {}\n", a[i], b[i])) {
+      const std::optional<std::string_view> line = co_await reader.ReadLine();
+      if (!line || !Scan<"{}   {}">(*line, a[i], b[i])) {
         throw std::runtime_error("bad input");
       }
     }
@@ -23,10 +26,11 @@ struct Input {
   int b[1000];
 };
 
-Task<void> Day01(tcp::Socket& socket) {
+Task<void> Day01(Stream& stream, Response& response) {
   std::println("parsing input...");
   Input input;
-  co_await input.Read(socket);
+  co_await input.Read(stream);
+  response.RecordEvent(Event::kInputParsed);
 
   std::println("sorting...");
   std::ranges::sort(input.a);
@@ -38,6 +42,7 @@ Task<void> Day01(tcp::Socket& socket) {
   }
 
   std::println("part 1: {}", delta);
+  response.RecordEvent(Event::kPart1Done);
 
   int score = 0;
   for (int i = 0; i < 1000; i++) {
@@ -46,10 +51,9 @@ Task<void> Day01(tcp::Socket& socket) {
   }
 
   std::println("part 2: {}", score);
+  response.RecordEvent(Event::kDone);
 
-  char result[32];
-  const char* end = std::format_to(result, "{}\n{}\n", delta, score);
-  co_await socket.Write(std::span<const char>(result, end - result));
+  response.Print("{}\n{}\n", delta, score);
 }
 
 }  // namespace aoc2024
@@ -1,7 +1,7 @@
 #include "../common/api.hpp"
 #include "../common/coro.hpp"
 #include "../common/scan.hpp"
-#include "tcp.hpp"
+#include "../common/stream.hpp"
 
 #include <algorithm>
 #include <cstring>
@@ -43,9 +43,9 @@ bool IsMostlySafe(std::span<const std::int8_t> values) {
   return false;
 }
 
-Task<void> Day02(tcp::Socket& socket) {
+Task<void> Day02(Stream& stream, Response& response) {
   char buffer[20000];
-  std::string_view input(co_await socket.Read(buffer));
+  std::string_view input(co_await stream.Read(buffer));
 
   int num_safe = 0;
   int num_mostly_safe = 0;
@@ -67,12 +67,11 @@ Task<void> Day02(tcp::Socket& socket) {
     num_mostly_safe += IsMostlySafe(values);
   }
 
+  response.RecordEvent(Event::kDone);
+
   std::println("part1: {}\npart2: {}", num_safe, num_mostly_safe);
 
-  char result[32];
-  const char* end =
-      std::format_to(result, "{}\n{}\n", num_safe, num_mostly_safe);
-  co_await socket.Write(std::span<const char>(result, end - result));
+  response.Print("{}\n{}\n", num_safe, num_mostly_safe);
 }
 
 }  // namespace aoc2024
@@ -1,7 +1,7 @@
 #include "../common/api.hpp"
 #include "../common/coro.hpp"
 #include "../common/scan.hpp"
-#include "tcp.hpp"
+#include "../common/stream.hpp"
 
 #include <algorithm>
 #include <cstring>
@@ -9,9 +9,9 @@
 
 namespace aoc2024 {
 
-Task<void> Day03(tcp::Socket& socket) {
+Task<void> Day03(Stream& stream, Response& response) {
   char buffer[20000];
-  std::string_view input(co_await socket.Read(buffer));
+  std::string_view input(co_await stream.Read(buffer));
   assert(input.size() < 20000);  // If we hit 20k then we may have truncated.
 
   bool enable = true;
@@ -35,11 +35,11 @@ Task<void> Day03(tcp::Socket& socket) {
     }
   }
 
+  response.RecordEvent(Event::kDone);
+
   std::println("part1: {}\npart2: {}\n", part1, part2);
 
-  char result[32];
-  const char* end = std::format_to(result, "{}\n{}\n", part1, part2);
-  co_await socket.Write(std::span<const char>(result, end - result));
+  response.Print("{}\n{}\n", part1, part2);
 }
 
 }  // namespace aoc2024
@@ -1,7 +1,7 @@
 #include "../common/api.hpp"
 #include "../common/coro.hpp"
 #include "../common/scan.hpp"
-#include "tcp.hpp"
+#include "../common/stream.hpp"
 
 #include <cctype>
 #include <algorithm>
@@ -10,9 +10,9 @@
 
 namespace aoc2024 {
 
-Task<void> Day05(tcp::Socket& socket) {
+Task<void> Day05(Stream& stream, Response& response) {
   char buffer[16000];
-  std::string_view input(co_await socket.Read(buffer));
+  std::string_view input(co_await stream.Read(buffer));
 
   // ordered[a][b] is true if `a|b` is a constraint.
   bool ordered[100][100] = {};
@@ -66,13 +66,11 @@ Task<void> Day05(tcp::Socket& socket) {
     }
   }
 
+  response.RecordEvent(Event::kDone);
+
   std::println("part1: {}\npart2: {}\n", part1, part2);
 
-  {
-    char result[32];
-    const char* end = std::format_to(result, "{}\n{}\n", part1, part2);
-    co_await socket.Write(std::span<const char>(result, end - result));
-  }
+  response.Print("{}\n{}\n", part1, part2);
 }
 
 }  // namespace aoc2024
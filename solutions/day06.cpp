@@ -1,12 +1,18 @@
 
 #include "../common/api.hpp"
 #include "../common/coro.hpp"
-#include "tcp.hpp"
+#include "../common/grid.hpp"
+#include "../common/parallel.hpp"
+#include "../common/stream.hpp"
+#include "../common/yield.hpp"
 
 #include <cctype>
 #include <algorithm>
+#include <bitset>
 #include <cstring>
+#include <optional>
 #include <print>
+#include <stdexcept>
 
 namespace aoc2024 {
 namespace {
@@ -18,81 +24,61 @@ enum Direction {
   kLeft,
 };
 
-struct Vec2 { int x, y; };
-
-Vec2 Step(Vec2 start, Direction direction) {
-  switch (direction) {
-    case kUp:
-      return Vec2{start.x, start.y - 1};
-    case kRight:
-      return Vec2{start.x + 1, start.y};
-    case kDown:
-      return Vec2{start.x, start.y + 1};
-    case kLeft:
-      return Vec2{start.x - 1, start.y};
-  }
-  std::abort();
-}
-
 Direction Rotate(Direction d) { return Direction((d + 1) % 4); }
 
-struct Grid {
-  static constexpr int kSize = 130;
-
-  static bool InBounds(Vec2 v) {
-    return 0 <= v.x && v.x < kSize && 0 <= v.y && v.y < kSize;
+// Cells are identified by their index in the grid (see `Grid`).
+struct Map {
+  explicit Map(Grid<const char> grid)
+      : grid(grid),
+        steps{-grid.stride(), 1, grid.stride(), -1},
+        num_cells(grid.height() * grid.stride()) {
+    if (num_cells > kMaxCells) throw std::runtime_error("grid too big");
+    const std::optional<int> guard = grid.Find('^');
+    if (!guard) throw std::runtime_error("no guard");
+    start_position = *guard;
   }
 
-  char& operator[](Vec2 v) const {
-    assert(InBounds(v));
-    return data[v.y * (kSize + 1) + v.x];
+  // The index of the cell in front of `position` when facing `direction`.
+  int Step(int position, Direction direction) const {
+    return position + steps[direction];
   }
 
+  // Whether the cell is beyond the edge of the map, which is the border of the
+  // grid.
+  bool Outside(int position) const { return grid[position] == '\n'; }
+
+  static constexpr int kMaxCells = 131 * 130;
   static constexpr Direction start_direction = kUp;
-  Vec2 start_position;
-  std::span<char> data;
+  Grid<const char> grid;
+  int steps[4];
+  int num_cells;
+  int start_position;
 };
 
 struct VisitedSet {
-  bool contains(Vec2 position) const {
-    return data[position.y][position.x];
-  }
+  bool contains(int position) const { return data[position]; }
 
-  bool contains(Vec2 position, Direction direction) const {
-    return data[position.y][position.x] & (1 << direction);
+  bool contains(int position, Direction direction) const {
+    return data[position] & (1 << direction);
   }
 
-  void insert(Vec2 position, Direction direction) {
-    data[position.y][position.x] |= 1 << direction;
+  void insert(int position, Direction direction) {
+    data[position] |= 1 << direction;
   }
 
-  std::uint8_t data[Grid::kSize][Grid::kSize] = {};
+  std::uint8_t data[Map::kMaxCells] = {};
 };
 
-Grid Parse(std::span<char> input) {
-  // The input should be a square grid plus newlines for each line.
-  assert(input.size() == (Grid::kSize + 1) * Grid::kSize);
-
-  // Find the start position.
-  const auto guard = std::ranges::find(input, '^');
-  assert(guard != input.end());
-  const int index = guard - input.begin();
-  const Vec2 start_position =
-      Vec2(index % (Grid::kSize + 1), index / (Grid::kSize + 1));
-
-  return Grid{.start_position = start_position, .data = input};
-}
-
-int Part1(const Grid& grid) {
+int Part1(const Map& map) {
   VisitedSet visited;
-  Vec2 position = grid.start_position;
-  Direction direction = grid.start_direction;
+  int position = map.start_position;
+  Direction direction = map.start_direction;
   visited.insert(position, kUp);
   int num_visited = 1;
   while (true) {
-    const Vec2 next = Step(position, direction);
-    if (!Grid::InBounds(next)) break;
-    if (grid[next] == '#') {
+    const int next = map.Step(position, direction);
+    if (map.Outside(next)) break;
+    if (map.grid[next] == '#') {
       // Rotate 90 degrees.
       direction = Rotate(direction);
     } else {
@@ -105,17 +91,20 @@ int Part1(const Grid& grid) {
   return num_visited;
 }
 
-// Returns true if the guard eventually loops from the given configuration.
-bool Loops(VisitedSet visited, Vec2 position, Direction direction,
-           const Grid& grid) {
+// Returns true if the guard eventually loops from the given configuration when
+// there is an extra obstacle at `obstacle`. A loop always includes a turn, so
+// it is sufficient to only record the turns.
+bool Loops(const Map& map, int obstacle, int position, Direction direction) {
+  std::bitset<Map::kMaxCells * 4> turns;
   while (true) {
-    const Vec2 next = Step(position, direction);
-    if (!Grid::InBounds(next)) return false;
-    if (grid[next] == '#') {
+    const int next = map.Step(position, direction);
+    if (map.Outside(next)) return false;
+    if (map.grid[next] == '#' || next == obstacle) {
       // Rotate 90 degrees.
       direction = Rotate(direction);
-      if (visited.contains(position, direction)) return true;
-      visited.insert(position, direction);
+      const int turn = position * 4 + direction;
+      if (turns[turn]) return true;
+      turns[turn] = true;
     } else {
       // Move forwards.
       position = next;
@@ -123,48 +112,64 @@ bool Loops(VisitedSet visited, Vec2 position, Direction direction,
   }
 }
 
-int Part2(const Grid& grid) {
-  VisitedSet visited;
-  Vec2 position = grid.start_position;
-  Direction direction = grid.start_direction;
-  visited.insert(position, direction);
-  int obstacle_positions = 0;
+Task<int> Part2(const Map& map) {
+  // Walk the original path, recording the direction in which the guard first
+  // enters each cell. An obstacle in a cell only changes the path from the
+  // point where the guard would first walk into it, so each cell on the path
+  // can be checked independently (and in parallel).
+  constexpr std::uint8_t kNotVisited = 0xFF;
+  std::uint8_t first_entry[Map::kMaxCells];
+  std::memset(first_entry, kNotVisited, sizeof(first_entry));
+  int position = map.start_position;
+  Direction direction = map.start_direction;
   while (true) {
-    const Vec2 next = Step(position, direction);
-    if (!Grid::InBounds(next)) break;
-    if (grid[next] == '#') {
+    const int next = map.Step(position, direction);
+    if (map.Outside(next)) break;
+    if (map.grid[next] == '#') {
       // Rotate 90 degrees.
       direction = Rotate(direction);
     } else {
-      if (!visited.contains(next)) {
-        // Temporarily insert an obstacle to see if it causes a loop.
-        grid[next] = '#';
-        if (Loops(visited, position, direction, grid)) obstacle_positions++;
-        grid[next] = ' ';
-      }
       // Move forwards.
       position = next;
+      auto& entry = first_entry[position];
+      if (entry == kNotVisited) entry = direction;
     }
-    visited.insert(position, direction);
   }
-  return obstacle_positions;
+  auto loops = [&](int obstacle) {
+    // An obstacle can't be placed at the start position.
+    if (obstacle == map.start_position) return 0;
+    const std::uint8_t entry = first_entry[obstacle];
+    if (entry == kNotVisited) return 0;
+    // Start from the cell before the obstacle, facing into it.
+    const Direction direction = Direction(entry);
+    const int position = map.Step(obstacle, Rotate(Rotate(direction)));
+    return int(Loops(map, obstacle, position, direction));
+  };
+  // A slice of cells at a time, so that other requests aren't held up.
+  constexpr int kSliceSize = 2048;
+  int count = 0;
+  for (int begin = 0; begin < map.num_cells; begin += kSliceSize) {
+    co_await MaybeYield();
+    count += co_await ParallelSum<int>(
+        begin, std::min(begin + kSliceSize, map.num_cells), loops);
+  }
+  co_return count;
 }
 
 }  // namespace
 
-Task<void> Day06(tcp::Socket& socket) {
-  char buffer[18000];
-  const std::span<char> input = co_await socket.Read(buffer);
-
-  const Grid grid = Parse(input);
-  const int part1 = Part1(grid);
-  const int part2 = Part2(grid);
+Task<void> Day06(Stream& stream, Response& response) {
+  char buffer[18000 + kGridPadding];
+  const Map map(co_await ReadGrid(stream, buffer));
+  response.RecordEvent(Event::kInputParsed);
+  const int part1 = Part1(map);
+  response.RecordEvent(Event::kPart1Done);
+  const int part2 = co_await Part2(map);
+  response.RecordEvent(Event::kDone);
 
   std::println("part1: {}\npart2: {}\n", part1, part2);
 
-  char result[32];
-  const char* end = std::format_to(result, "{}\n{}\n", part1, part2);
-  co_await socket.Write(std::span<const char>(result, end - result));
+  response.Print("{}\n{}\n", part1, part2);
 }
 
 }  // namespace aoc2024
@@ -1,7 +1,8 @@
 #include "../common/api.hpp"
+#include "../common/buffered_reader.hpp"
 #include "../common/coro.hpp"
 #include "../common/scan.hpp"
-#include "tcp.hpp"
+#include "../common/stream.hpp"
 
 #include <cctype>
 #include <algorithm>
@@ -23,24 +24,25 @@ struct Record {
 struct Input {
   static constexpr int kMaxRecords = 850;
 
-  Task<void> Read(tcp::Socket& socket) {
-    char buffer[26000];
-    std::string_view input(co_await socket.Read(buffer));
+  Task<void> Read(Stream& stream) {
+    char buffer[128];
+    BufferedReader reader(stream, buffer);
 
-    while (!input.empty()) {
+    while (std::optional<std::string_view> line = co_await reader.ReadLine()) {
+      std::string_view input = *line;
       if (num_records == kMaxRecords) {
         throw std::runtime_error("too many records");
       }
       Record& record = records[num_records++];
-      if (!ScanPrefix(input, "{}: {}", record.target, record.values[0])) {
+      if (!ScanPrefix<"{}: {}">(input, record.target, record.values[0])) {
         throw std::runtime_error("bad line");
       }
       record.num_values = 1;
-      while (!ScanPrefix(input, "\n")) {
+      while (!input.empty()) {
         if (record.num_values == Record::kMaxValues) {
           throw std::runtime_error("too many values in line");
         }
-        if (!ScanPrefix(input, " {}", record.values[record.num_values++])) {
+        if (!ScanPrefix<" {}">(input, record.values[record.num_values++])) {
           throw std::runtime_error("bad line");
         }
       }
@@ -107,17 +109,18 @@ std::uint64_t CalibrationResult(const Input& input) {
 
 }  // namespace
 
-Task<void> Day07(tcp::Socket& socket) {
+Task<void> Day07(Stream& stream, Response& response) {
   Input input;
-  co_await input.Read(socket);
+  co_await input.Read(stream);
+  response.RecordEvent(Event::kInputParsed);
 
   const std::uint64_t part1 = CalibrationResult<CanProduce<false>>(input);
+  response.RecordEvent(Event::kPart1Done);
   const std::uint64_t part2 = CalibrationResult<CanProduce<true>>(input);
+  response.RecordEvent(Event::kDone);
   std::println("part1: {}\npart2: {}\n", part1, part2);
 
-  char result[32];
-  const char* end = std::format_to(result, "{}\n{}\n", part1, part2);
-  co_await socket.Write(std::span<const char>(result, end - result));
+  response.Print("{}\n{}\n", part1, part2);
 }
 
 }  // namespace aoc2024
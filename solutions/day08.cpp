@@ -1,6 +1,6 @@
 #include "../common/api.hpp"
 #include "../common/coro.hpp"
-#include "tcp.hpp"
+#include "../common/stream.hpp"
 
 #include <cctype>
 #include <algorithm>
@@ -28,9 +28,9 @@ constexpr int kGridSize = 50;
 struct Input {
   static constexpr int kMaxAntennas = 200;
 
-  Task<void> Read(tcp::Socket& socket) {
+  Task<void> Read(Stream& stream) {
     char buffer[2560];
-    std::string_view input(co_await socket.Read(buffer));
+    std::string_view input(co_await stream.Read(buffer));
     assert(input.size() == (kGridSize + 1) * kGridSize);
 
     for (std::int8_t y = 0; y < kGridSize; y++) {
@@ -122,20 +122,21 @@ int Part2(std::span<const Antenna> antennas) {
 
 }  // namespace
 
-Task<void> Day08(tcp::Socket& socket) {
+Task<void> Day08(Stream& stream, Response& response) {
   Input input;
-  co_await input.Read(socket);
+  co_await input.Read(stream);
+  response.RecordEvent(Event::kInputParsed);
   const std::span<Antenna> antennas(input.antennas, input.num_antennas);
 
   // Part 1.
   const int part1 = Part1(antennas);
+  response.RecordEvent(Event::kPart1Done);
   const int part2 = Part2(antennas);
+  response.RecordEvent(Event::kDone);
 
   std::println("part1: {}\npart2: {}\n", part1, part2);
 
-  char result[32];
-  const char* end = std::format_to(result, "{}\n{}\n", part1, part2);
-  co_await socket.Write(std::span<const char>(result, end - result));
+  response.Print("{}\n{}\n", part1, part2);
 }
 
 }  // namespace aoc2024
@@ -1,6 +1,6 @@
 #include "../common/api.hpp"
 #include "../common/coro.hpp"
-#include "tcp.hpp"
+#include "../common/stream.hpp"
 
 #include <cctype>
 #include <algorithm>
@@ -121,20 +121,21 @@ std::int64_t Part2(const std::span<char> input) {
   return checksum;
 }
 
-Task<void> Day09(tcp::Socket& socket) {
+Task<void> Day09(Stream& stream, Response& response) {
   char buffer[20001];
-  std::span<char> input = co_await socket.Read(buffer);
+  std::span<char> input = co_await stream.Read(buffer);
   assert(input.size() <= 20000 && input.back() == '\n');
   input = input.subspan(0, input.size() - 1);
   assert(input.size() % 2 == 1);
+  response.RecordEvent(Event::kInputParsed);
 
   const std::int64_t part1 = Part1(input);
+  response.RecordEvent(Event::kPart1Done);
   const std::int64_t part2 = Part2(input);
+  response.RecordEvent(Event::kDone);
   std::println("part1: {}\npart2: {}\n", part1, part2);
 
-  char result[32];
-  const char* end = std::format_to(result, "{}\n{}\n", part1, part2);
-  co_await socket.Write(std::span<const char>(result, end - result));
+  response.Print("{}\n{}\n", part1, part2);
 }
 
 }  // namespace aoc2024
@@ -1,12 +1,15 @@
 #include "../common/api.hpp"
+#include "../common/bit_grid.hpp"
 #include "../common/coro.hpp"
-#include "tcp.hpp"
+#include "../common/grid.hpp"
+#include "../common/stream.hpp"
 
 #include <cctype>
 #include <algorithm>
 #include <cstring>
 #include <print>
 #include <ranges>
+#include <stdexcept>
 
 namespace aoc2024 {
 namespace {
@@ -15,45 +18,23 @@ constexpr int kSize = 47;
 
 struct Vec { std::int8_t x, y; };
 
-struct Input {
-  auto& operator[](this auto&& self, int x, int y) {
-    assert(0 <= x && x <= self.width && 0 <= y && y <= self.height);
-    return self.text[y * (self.width + 1) + x];
-  }
-
-  bool InBounds(int x, int y) const {
-    return 0 <= x && x < width && 0 <= y && y < height;
-  }
-
-  bool InBounds(Vec v) const { return InBounds(v.x, v.y); }
-
-  std::string_view text;
-  int width, height;
-};
+// The border of the grid never matches a height, so no step leaves the grid.
+using Input = Grid<const char>;
 
 static constexpr int kDeltas[][2] = {{1, 0}, {-1, 0}, {0, -1}, {0, 1}};
 
-Task<Input> ReadInput(tcp::Socket& socket, std::span<char> buffer) {
-  std::string_view input(co_await socket.Read(buffer));
-  assert(input.size() <= (kSize + 1) * kSize && input.back() == '\n');
-  const int width = input.find('\n');
-  assert(width <= kSize);
-  assert(input.size() % (width + 1) == 0);
-  const int height = input.size() / (width + 1);
-  assert(height <= kSize);
-  co_return Input(input, width, height);
-}
+// The cells which have been visited, at one bit per cell.
+using VisitedSet = BitGrid<kSize, kSize>;
 
 // Returns the total number of '9' cells reachable from `(x, y)` (a cell
 // containing value `c`) which have not already been seen according to `seen`.
-int Explore(const Input& input, int x, int y, char c,
-            bool (&seen)[kSize][kSize]) {
-  if (seen[y][x]) return 0;  // Avoid double-counting.
-  seen[y][x] = true;
+int Explore(const Input& input, int x, int y, char c, VisitedSet& seen) {
+  if (seen[x, y]) return 0;  // Avoid double-counting.
+  seen.Set(x, y);
   if (c == '9') return 1;
   int total = 0;
   for (const auto [dx, dy] : kDeltas) {
-    if (input.InBounds(x + dx, y + dy) && input[x + dx, y + dy] == c + 1) {
+    if (input[x + dx, y + dy] == c + 1) {
       total += Explore(input, x + dx, y + dy, c + 1, seen);
     }
   }
@@ -62,10 +43,10 @@ int Explore(const Input& input, int x, int y, char c,
 
 int Part1(const Input& input) {
   int total = 0;
-  for (int y = 0; y < input.height; y++) {
-    for (int x = 0; x < input.width; x++) {
+  for (int y = 0; y < input.height(); y++) {
+    for (int x = 0; x < input.width(); x++) {
       if (input[x, y] != '0') continue;
-      bool seen[kSize][kSize] = {};
+      VisitedSet seen;
       total += Explore(input, x, y, '0', seen);
     }
   }
@@ -83,8 +64,8 @@ int Part2(const Input& input) {
   int last_step = 0;
   int next_node = 0;
   // Add all trailheads to the `count` and `nodes` arrays.
-  for (int y = 0; y < input.height; y++) {
-    for (int x = 0; x < input.width; x++) {
+  for (int y = 0; y < input.height(); y++) {
+    for (int x = 0; x < input.width(); x++) {
       if (input[x, y] == '0') {
         count[y][x] = 1;
         nodes[next_node++] = Vec(x, y);
@@ -99,7 +80,7 @@ int Part2(const Input& input) {
     for (Vec node : previous) {
       for (const auto [dx, dy] : kDeltas) {
         const Vec n = Vec(node.x + dx, node.y + dy);
-        if (input.InBounds(n) && input[n.x, n.y] == '0' + step) {
+        if (input[n] == '0' + step) {
           if (count[n.y][n.x] == 0) nodes[next_node++] = n;
           count[n.y][n.x] += count[node.y][node.x];
         }
@@ -118,17 +99,21 @@ int Part2(const Input& input) {
 
 }  // namespace
 
-Task<void> Day10(tcp::Socket& socket) {
-  char buffer[2257];
-  const Input input = co_await ReadInput(socket, buffer);
+Task<void> Day10(Stream& stream, Response& response) {
+  char buffer[2257 + kGridPadding];
+  const Input input = co_await ReadGrid(stream, buffer);
+  if (input.width() > kSize || input.height() > kSize) {
+    throw std::runtime_error("grid too big");
+  }
+  response.RecordEvent(Event::kInputParsed);
 
   const int part1 = Part1(input);
+  response.RecordEvent(Event::kPart1Done);
   const int part2 = Part2(input);
+  response.RecordEvent(Event::kDone);
   std::println("part1: {}\npart2: {}\n", part1, part2);
 
-  char result[32];
-  const char* end = std::format_to(result, "{}\n{}\n", part1, part2);
-  co_await socket.Write(std::span<const char>(result, end - result));
+  response.Print("{}\n{}\n", part1, part2);
 }
 
 }  // namespace aoc2024
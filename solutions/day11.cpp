@@ -1,7 +1,7 @@
 #include "../common/api.hpp"
 #include "../common/coro.hpp"
 #include "../common/scan.hpp"
-#include "tcp.hpp"
+#include "../common/stream.hpp"
 
 #include <cctype>
 #include <algorithm>
@@ -47,10 +47,10 @@ std::span<StoneType> Combine(std::span<StoneType> entries) {
   return entries.subspan(0, j);
 }
 
-Task<std::span<StoneType>> ReadInput(tcp::Socket& socket,
+Task<std::span<StoneType>> ReadInput(Stream& stream,
                                      std::span<StoneType> buffer) {
   char text[128];
-  std::string_view input(co_await socket.Read(text));
+  std::string_view input(co_await stream.Read(text));
   if (!ScanPrefix(input, "{}", buffer[0])) {
     throw std::runtime_error("no stones");
   }
@@ -122,20 +122,21 @@ std::span<StoneType> Blink(std::span<const StoneType> before,
 
 }  // namespace
 
-Task<void> Day11(tcp::Socket& socket) {
+Task<void> Day11(Stream& stream, Response& response) {
   // We have space for two lists of stones. Each iteration reads from one buffer
   // and writes to the other buffer.
   StoneType buffers[2][4096];
-  std::span<StoneType> stones = co_await ReadInput(socket, buffers[1]);
+  std::span<StoneType> stones = co_await ReadInput(stream, buffers[1]);
+  response.RecordEvent(Event::kInputParsed);
   for (int i = 0; i < 25; i++) stones = Blink(stones, buffers[i % 2]);
   const std::uint64_t part1 = Count(stones);
+  response.RecordEvent(Event::kPart1Done);
   for (int i = 25; i < 75; i++) stones = Blink(stones, buffers[i % 2]);
   const std::uint64_t part2 = Count(stones);
+  response.RecordEvent(Event::kDone);
   std::println("part1: {}\npart2: {}\n", part1, part2);
 
-  char result[32];
-  const char* end = std::format_to(result, "{}\n{}\n", part1, part2);
-  co_await socket.Write(std::span<const char>(result, end - result));
+  response.Print("{}\n{}\n", part1, part2);
 }
 
 }  // namespace aoc2024
@@ -2,42 +2,39 @@
 #include <cctype>
 #include <cstring>
 #include <print>
-#include <ranges>
 
 #include "../common/api.hpp"
 #include "../common/coro.hpp"
+#include "../common/record_scanner.hpp"
 #include "../common/scan.hpp"
-#include "tcp.hpp"
+#include "../common/stream.hpp"
 
 namespace aoc2024 {
 namespace {
 
-using std::literals::operator""sv;
-
 struct Vec { std::int64_t x, y; };
 struct Machine { Vec a, b, prize; };
 
-Task<std::span<Machine>> ReadInput(tcp::Socket& socket,
+Task<std::span<Machine>> ReadInput(Stream& stream,
                                    std::span<Machine> machines) {
   const int max_machines = machines.size();
   int num_machines = 0;
-  char buffer[22000];
-  std::string_view input(co_await socket.Read(buffer));
-  if (input.empty() || input.back() != '\n') {
-    throw std::runtime_error("bad input");
-  }
-  input.remove_suffix(1);
-  for (const auto entry : std::ranges::views::split(input, "\n\n"sv)) {
+  RecordScanner scanner(stream);
+  while (co_await scanner.Fill()) {
     if (num_machines == max_machines) {
       throw std::runtime_error("too many machines");
     }
+    // Machines are separated by blank lines.
+    if (num_machines > 0 && !ScanPrefix(scanner.input(), "\n")) {
+      throw std::runtime_error("bad input");
+    }
     Machine& machine = machines[num_machines++];
-    if (!Scan(std::string_view(entry),
-              "Button A: X+{}, Y+{}\n"
-              "Button B: X+{}, Y+{}\n"
-              "Prize: X={}, Y={}",
-              machine.a.x, machine.a.y, machine.b.x, machine.b.y,
-              machine.prize.x, machine.prize.y)) {
+    if (!ScanPrefix(scanner.input(),
+                    "Button A: X+{}, Y+{}\n"
+                    "Button B: X+{}, Y+{}\n"
+                    "Prize: X={}, Y={}\n",
+                    machine.a.x, machine.a.y, machine.b.x, machine.b.y,
+                    machine.prize.x, machine.prize.y)) {
       throw std::runtime_error("bad machine description");
     }
   }
@@ -81,17 +78,18 @@ std::int64_t Part2(std::span<const Machine> machines) {
 
 }  // namespace
 
-Task<void> Day13(tcp::Socket& socket) {
+Task<void> Day13(Stream& stream, Response& response) {
   Machine buffer[320];
-  std::span<Machine> machines = co_await ReadInput(socket, buffer);
+  std::span<Machine> machines = co_await ReadInput(stream, buffer);
+  response.RecordEvent(Event::kInputParsed);
 
   const std::int64_t part1 = Part1(machines);
+  response.RecordEvent(Event::kPart1Done);
   const std::int64_t part2 = Part2(machines);
+  response.RecordEvent(Event::kDone);
   std::println("part1: {}\npart2: {}\n", part1, part2);
 
-  char result[32];
-  const char* end = std::format_to(result, "{}\n{}\n", part1, part2);
-  co_await socket.Write(std::span<const char>(result, end - result));
+  response.Print("{}\n{}\n", part1, part2);
 }
 
 }  // namespace aoc2024
@@ -6,9 +6,10 @@
 #include <iostream>
 
 #include "../common/api.hpp"
+#include "../common/buffered_reader.hpp"
 #include "../common/coro.hpp"
 #include "../common/scan.hpp"
-#include "tcp.hpp"
+#include "../common/stream.hpp"
 
 namespace aoc2024 {
 namespace {
@@ -31,19 +32,19 @@ constexpr Vec operator%(Vec a, Vec b) {
   return a;
 }
 
-Task<std::span<Robot>> ReadInput(tcp::Socket& socket,
+Task<std::span<Robot>> ReadInput(Stream& stream,
                                  std::span<Robot> robots) {
   const int max_robots = robots.size();
   int num_robots = 0;
-  char buffer[10000];
-  std::string_view input(co_await socket.Read(buffer));
-  while (!input.empty()) {
+  char buffer[32];
+  BufferedReader reader(stream, buffer);
+  while (std::optional<std::string_view> line = co_await reader.ReadLine()) {
     if (num_robots == max_robots) {
       throw std::runtime_error("too many robots");
     }
     Robot& robot = robots[num_robots++];
-    if (!ScanPrefix(input, "p={},{} v={},{}\n", robot.p.x, robot.p.y, robot.v.x,
-                    robot.v.y)) {
+    if (!Scan<"p={},{} v={},{}">(*line, robot.p.x, robot.p.y, robot.v.x,
+                                 robot.v.y)) {
       throw std::runtime_error("bad robot description");
     }
   }
@@ -89,17 +90,18 @@ std::int64_t Part2(std::span<Robot> robots) {
 
 }  // namespace
 
-Task<void> Day14(tcp::Socket& socket) {
+Task<void> Day14(Stream& stream, Response& response) {
   Robot buffer[500];
-  std::span<Robot> robots = co_await ReadInput(socket, buffer);
+  std::span<Robot> robots = co_await ReadInput(stream, buffer);
+  response.RecordEvent(Event::kInputParsed);
 
   const std::int64_t part1 = Part1(robots);
+  response.RecordEvent(Event::kPart1Done);
   const std::int64_t part2 = Part2(robots);
+  response.RecordEvent(Event::kDone);
   std::println("part1: {}\npart2: {}\n", part1, part2);
 
-  char result[32];
-  const char* end = std::format_to(result, "{}\n{}\n", part1, part2);
-  co_await socket.Write(std::span<const char>(result, end - result));
+  response.Print("{}\n{}\n", part1, part2);
 }
 
 }  // namespace aoc2024
@@ -1,6 +1,8 @@
+#include "../common/api.hpp"
 #include "../common/coro.hpp"
+#include "../common/grid.hpp"
 #include "../common/scan.hpp"
-#include "tcp.hpp"
+#include "../common/stream.hpp"
 
 #include <algorithm>
 #include <print>
@@ -17,18 +19,6 @@ Vec operator+(Vec l, Vec r) { return Vec(l.x + r.x, l.y + r.y); }
 Vec operator-(Vec l, Vec r) { return Vec(l.x - r.x, l.y - r.y); }
 Vec& operator+=(Vec& l, Vec r) { return l = l + r; }
 
-struct Grid {
-  char& operator[](int x, int y) {
-    assert(0 <= x && x < width && 0 <= y && y < height);
-    return data[y * (width + 1) + x];
-  }
-
-  char& operator[](Vec v) { return (*this)[v.x, v.y]; }
-
-  std::span<char> data;
-  int width, height;
-};
-
 struct Input {
   Input() = default;
 
@@ -36,32 +26,25 @@ struct Input {
   Input(const Input&) = delete;
   Input& operator=(const Input&) = delete;
 
-  Task<void> Read(tcp::Socket& socket) {
-    std::span<char> input = co_await socket.Read(input_buffer);
+  Task<void> Read(Stream& stream) {
+    std::span<char> input = co_await stream.Read(input_buffer);
     if (input.empty() || input.back() != '\n') {
       throw std::runtime_error("bad input (truncated)");
     }
 
-    // This must succeed: the input ends with '\n'.
-    grid.width = std::string_view(input).find('\n');
     // This can fail, so we need to check for npos and avoid overflow by
     // preserving the size_type instead of using an int.
     const auto grid_end = std::string_view(input).find("\n\n");
     if (grid_end == std::string_view::npos) {
       throw std::runtime_error("bad input (no grid end)");
     }
-    if ((grid_end + 1) % (grid.width + 1) != 0) {
-      throw std::runtime_error("grid is not rectangular");
-    }
-    grid.data = input.subspan(0, grid_end);
-    grid.height = (grid_end + 1) / (grid.width + 1);
+    // The grid is surrounded by walls, so moves never leave it.
+    grid = ParseGrid(input.subspan(0, grid_end + 1));
     input = input.subspan(grid_end + 2);
 
-    const auto robot_index = std::string_view(grid.data).find('@');
-    if (robot_index == std::string_view::npos) {
-      throw std::runtime_error("no robot");
-    }
-    robot = Vec(robot_index % (grid.width + 1), robot_index / (grid.width + 1));
+    const std::optional<int> robot_index = grid.Find('@');
+    if (!robot_index) throw std::runtime_error("no robot");
+    robot = grid.Position<Vec>(*robot_index);
 
     // Parse the sequence lines.
     int num_sequences = 0;
@@ -84,7 +67,7 @@ struct Input {
 
   char input_buffer[24000];
   std::span<char> sequence_buffer[20];
-  Grid grid;
+  Grid<char> grid;
   Vec robot;
   std::span<std::span<char>> sequences;
 };
@@ -102,10 +85,10 @@ Vec Direction(char direction) {
 int Part1(const Input& input) {
   // Make a copy of the input grid which we can modify.
   char buffer[2550];
-  assert(input.grid.data.size() <= 2550);
-  std::span<char> data = std::span(buffer).subspan(0, input.grid.data.size());
-  std::ranges::copy(input.grid.data, data.data());
-  Grid grid = Grid(data, input.grid.width, input.grid.height);
+  const int width = input.grid.width(), height = input.grid.height();
+  assert(width * height <= 2550);
+  const Grid<char> grid(buffer, width, height, width);
+  grid.Assign(input.grid);
   Vec robot = input.robot;
   for (std::span<char> sequence : input.sequences) {
     for (char move : sequence) {
@@ -136,8 +119,8 @@ int Part1(const Input& input) {
   //   (fixed bug where I wasn't updating the robot position in the grid).
   // 1552463 right answer
   int total = 0;
-  for (int y = 0; y < grid.height; y++) {
-    for (int x = 0; x < grid.width; x++) {
+  for (int y = 0; y < grid.height(); y++) {
+    for (int x = 0; x < grid.width(); x++) {
       if (grid[x, y] == 'O') total += 100 * y + x;
     }
   }
@@ -145,21 +128,19 @@ int Part1(const Input& input) {
 }
 
 struct ExpandedGrid {
-  Grid grid;
+  Grid<char> grid;
   Vec robot;
 };
 
 // Expands the input grid into the wider grid for part 2, using the provided
 // buffer for storage space.
-ExpandedGrid ExpandGrid(Grid input, std::span<char> buffer) {
-  const int required_size = (input.width * 2 + 1) * input.height;
-  assert(required_size <= int(buffer.size()));
-  Grid output{.data = buffer.subspan(0, required_size),
-              .width = 2 * input.width,
-              .height = input.height};
+ExpandedGrid ExpandGrid(Grid<const char> input, std::span<char> buffer) {
+  const int width = 2 * input.width();
+  assert(width * input.height() <= int(buffer.size()));
+  const Grid<char> output(buffer.data(), width, input.height(), width);
   std::optional<Vec> robot;
-  for (int y = 0; y < input.height; y++) {
-    for (int x = 0; x < input.width; x++) {
+  for (int y = 0; y < input.height(); y++) {
+    for (int x = 0; x < input.width(); x++) {
       switch (input[x, y]) {
         case '#':
         case '.':
@@ -183,7 +164,8 @@ ExpandedGrid ExpandGrid(Grid input, std::span<char> buffer) {
   return {.grid = output, .robot = *robot};
 }
 
-std::span<Vec> LeftPushableBoxes(Vec robot, Grid grid, std::span<Vec> boxes) {
+std::span<Vec> LeftPushableBoxes(Vec robot, Grid<char> grid,
+                                  std::span<Vec> boxes) {
   const int y = robot.y;
   assert((grid[robot.x - 2, y] == '[' && grid[robot.x - 1, y] == ']'));
   int num_boxes = 0;
@@ -198,7 +180,8 @@ std::span<Vec> LeftPushableBoxes(Vec robot, Grid grid, std::span<Vec> boxes) {
   return grid[x, y] == '#' ? std::span<Vec>() : boxes.subspan(0, num_boxes);
 }
 
-std::span<Vec> RightPushableBoxes(Vec robot, Grid grid, std::span<Vec> boxes) {
+std::span<Vec> RightPushableBoxes(Vec robot, Grid<char> grid,
+                                   std::span<Vec> boxes) {
   const int y = robot.y;
   assert((grid[robot.x + 1, y] == '[' && grid[robot.x + 2, y] == ']'));
   int num_boxes = 0;
@@ -213,7 +196,7 @@ std::span<Vec> RightPushableBoxes(Vec robot, Grid grid, std::span<Vec> boxes) {
   return grid[x, y] == '#' ? std::span<Vec>() : boxes.subspan(0, num_boxes);
 }
 
-std::span<Vec> VerticallyPushableBoxes(Vec robot, int dy, Grid grid,
+std::span<Vec> VerticallyPushableBoxes(Vec robot, int dy, Grid<char> grid,
                                        std::span<Vec> boxes) {
   const Vec initial = robot + Vec(0, dy);
   assert(grid[initial] == '[' || grid[initial] == ']');
@@ -243,7 +226,7 @@ std::span<Vec> VerticallyPushableBoxes(Vec robot, int dy, Grid grid,
 // This must only be called when the robot is pushing against a box. If an empty
 // span is returned, this means that no box can be pushed and the robot should
 // not move.
-std::span<Vec> PushableBoxes(Vec robot, Vec direction, Grid grid,
+std::span<Vec> PushableBoxes(Vec robot, Vec direction, Grid<char> grid,
                              std::span<Vec> boxes) {
   assert(!boxes.empty());
   if (direction.x == -1) return LeftPushableBoxes(robot, grid, boxes);
@@ -289,8 +272,8 @@ int Part2(const Input& input) {
     }
   }
   int total = 0;
-  for (int y = 0; y < grid.height; y++) {
-    for (int x = 0; x < grid.width; x++) {
+  for (int y = 0; y < grid.height(); y++) {
+    for (int x = 0; x < grid.width(); x++) {
       if (grid[x, y] == '[') total += 100 * y + x;
     }
   }
@@ -299,17 +282,18 @@ int Part2(const Input& input) {
 
 }  // namespace
 
-Task<void> Day15(tcp::Socket& socket) {
+Task<void> Day15(Stream& stream, Response& response) {
   Input input;
-  co_await input.Read(socket);
+  co_await input.Read(stream);
+  response.RecordEvent(Event::kInputParsed);
 
   const int part1 = Part1(input);
+  response.RecordEvent(Event::kPart1Done);
   const int part2 = Part2(input);
+  response.RecordEvent(Event::kDone);
   std::println("part1: {}\npart2: {}\n", part1, part2);
 
-  char result[32];
-  const char* end = std::format_to(result, "{}\n{}\n", part1, part2);
-  co_await socket.Write(std::span<const char>(result, end - result));
+  response.Print("{}\n{}\n", part1, part2);
 }
 
 }  // namespace aoc2024
@@ -1,6 +1,9 @@
+#include "../common/api.hpp"
 #include "../common/coro.hpp"
+#include "../common/frontier.hpp"
+#include "../common/grid.hpp"
 #include "../common/scan.hpp"
-#include "tcp.hpp"
+#include "../common/stream.hpp"
 
 #include <algorithm>
 #include <print>
@@ -38,18 +41,6 @@ Vec Step(Vec v, Direction d, std::uint8_t distance) {
 
 Vec operator+(Vec v, Direction d) { return Step(v, d, 1); }
 
-struct Grid {
-  char& operator[](int x, int y) {
-    assert(0 <= x && x < width && 0 <= y && y < height);
-    return data[y * (width + 1) + x];
-  }
-
-  char& operator[](Vec v) { return (*this)[v.x, v.y]; }
-
-  std::span<char> data;
-  int width, height;
-};
-
 struct Input {
   Input() = default;
 
@@ -57,70 +48,36 @@ struct Input {
   Input(const Input&) = delete;
   Input& operator=(const Input&) = delete;
 
-  Task<void> Read(tcp::Socket& socket) {
-    std::span<char> input = co_await socket.Read(input_buffer);
-    if (input.empty() || input.back() != '\n') {
-      throw std::runtime_error("bad input (truncated)");
-    }
-
-    // This must succeed: the input ends with '\n'.
-    grid.width = std::string_view(input).find('\n');
-    if (input.size() % (grid.width + 1) != 0) {
-      throw std::runtime_error("grid is not rectangular");
-    }
-    grid.data = input;
-    grid.height = input.size() / (grid.width + 1);
+  Task<void> Read(Stream& stream) {
+    std::span<char> input = co_await stream.Read(input_buffer);
+    // The maze is surrounded by walls, so the search never leaves the grid.
+    grid = ParseGrid(input);
 
-    const auto start_index = std::string_view(grid.data).find('S');
-    if (start_index == std::string_view::npos) {
-      throw std::runtime_error("no start");
-    }
-    start = Vec(start_index % (grid.width + 1), start_index / (grid.width + 1));
+    const std::optional<int> start_index = grid.Find('S');
+    if (!start_index) throw std::runtime_error("no start");
+    start = grid.Position<Vec>(*start_index);
 
-    const auto end_index = std::string_view(grid.data).find('E');
-    if (end_index == std::string_view::npos) {
-      throw std::runtime_error("no end");
-    }
-    end = Vec(end_index % (grid.width + 1), end_index / (grid.width + 1));
+    const std::optional<int> end_index = grid.Find('E');
+    if (!end_index) throw std::runtime_error("no end");
+    end = grid.Position<Vec>(*end_index);
   }
 
   char input_buffer[24000];
-  Grid grid;
+  Grid<char> grid;
   Vec start, end;
 };
 
-class Frontier {
- public:
-  struct Node {
-    // Cost to reach this position.
-    int cost;
-    // Actual cost plus heuristic estimate of the cost to reach the goal.
-    int guess;
-    Vec position;
-    Direction direction;
-  };
-
-  bool Empty() const { return size_ == 0; }
-
-  Node Pop() {
-    assert(!Empty());
-    std::ranges::pop_heap(data_, data_ + size_, std::greater<>(), &Node::guess);
-    return data_[--size_];
-  }
-
-  void Push(Node node) {
-    assert(size_ < kMaxSize);
-    data_[size_++] = node;
-    std::ranges::push_heap(data_, data_ + size_, std::greater<>(),
-                           &Node::guess);
-  }
-
- private:
-  static constexpr int kMaxSize = 1000;
-  Node data_[1000];
-  int size_ = 0;
+struct Node {
+  // Cost to reach this position.
+  int cost;
+  Vec position;
+  Direction direction;
 };
 
+// Each move costs 2 plus 1000 for each quarter turn, so there is a bucket for
+// every cost up to a move with a half turn.
+using Frontier = BucketFrontier<Node, &Node::cost, 1000, 2002>;
+
 struct VisitedSet {
   struct Cell {
     std::uint32_t seen : 1;
@@ -145,30 +102,24 @@ struct VisitedSet {
   Cell cells[70][70][4] = {};
 };
 
-int GuessCost(Vec position, Vec end) {
-  const int dx = std::abs(position.x - end.x),
-            dy = std::abs(position.y - end.y);
-  return dx + dy + (dx && dy ? 1000 : 0);
-}
-
 Direction Rotate(Direction direction, int num_clockwise_quarter_turns) {
   assert(-4 < num_clockwise_quarter_turns && num_clockwise_quarter_turns <= 4);
   return Direction((direction + num_clockwise_quarter_turns + 4) % 4);
 }
 
-int Part1(Input& input, VisitedSet& visited) {
-  // Search for the cheapest path using A*. As a side effect, the visited set is
-  // populated with the cost of reaching each position. This is used to solve
-  // part 2.
+int Part1(Input& input, VisitedSet& visited, Response& response) {
+  // Search for the cheapest path using Dijkstra's algorithm. As a side effect,
+  // the visited set is populated with the cost of reaching each position. This
+  // is used to solve part 2.
+  TraceSpan span(response, "dijkstra search");
   Frontier frontier;
   frontier.Push({
       .cost = 0,
-      .guess = GuessCost(input.start, input.end),
       .position = input.start,
       .direction = kRight,
   });
   while (!frontier.Empty()) {
-    const Frontier::Node node = frontier.Pop();
+    const Node node = frontier.Pop();
     const bool is_new =
         visited.Insert(node.position, node.direction, node.cost);
     if (!is_new) continue;
@@ -180,7 +131,6 @@ int Part1(Input& input, VisitedSet& visited) {
       const int cost = node.cost + 1000 * std::abs(rotation) + 2;
       frontier.Push({
           .cost = cost,
-          .guess = cost + GuessCost(position, input.end),
           .position = position,
           .direction = direction,
       });
@@ -189,7 +139,7 @@ int Part1(Input& input, VisitedSet& visited) {
   throw std::runtime_error("end not found");
 }
 
-int Part2(Input& input, const VisitedSet& visited) {
+int Part2(Input& input, const VisitedSet& visited, Response& response) {
   // Starting at the end position (in whatever orientation it was reached*),
   // use the costs in the visited set to backtrack along any path which matches
   // the minimum cost. This can branch when we have two paths that rejoin with
@@ -212,6 +162,7 @@ int Part2(Input& input, const VisitedSet& visited) {
       stack[stack_size++] = Node(input.end, Direction(d));
     }
   }
+  TraceSpan backtrack_span(response, "backtrack");
   while (stack_size > 0) {
     const Node node = stack[--stack_size];
     const Vec p = node.position;
@@ -249,18 +200,19 @@ int Part2(Input& input, const VisitedSet& visited) {
 
 }  // namespace
 
-Task<void> Day16(tcp::Socket& socket) {
+Task<void> Day16(Stream& stream, Response& response) {
   Input input;
-  co_await input.Read(socket);
+  co_await input.Read(stream);
+  response.RecordEvent(Event::kInputParsed);
 
   VisitedSet visited;
-  const int part1 = Part1(input, visited);
-  const int part2 = Part2(input, visited);
+  const int part1 = Part1(input, visited, response);
+  response.RecordEvent(Event::kPart1Done);
+  const int part2 = Part2(input, visited, response);
+  response.RecordEvent(Event::kDone);
   std::println("part1: {}\npart2: {}\n", part1, part2);
 
-  char result[32];
-  const char* end = std::format_to(result, "{}\n{}\n", part1, part2);
-  co_await socket.Write(std::span<const char>(result, end - result));
+  response.Print("{}\n{}\n", part1, part2);
 }
 
 }  // namespace aoc2024
@@ -5,7 +5,7 @@
 #include "../common/api.hpp"
 #include "../common/coro.hpp"
 #include "../common/scan.hpp"
-#include "tcp.hpp"
+#include "../common/stream.hpp"
 
 namespace aoc2024 {
 namespace {
@@ -22,9 +22,9 @@ enum Operation : std::uint8_t {
 };
 
 struct Input {
-  Task<void> Read(tcp::Socket& socket) {
+  Task<void> Read(Stream& stream) {
     char input_buffer[128];
-    std::string_view input(co_await socket.Read(input_buffer));
+    std::string_view input(co_await stream.Read(input_buffer));
     if (!ScanPrefix(input,
                     "Register A: {}\n"
                     "Register B: {}\n"
@@ -144,18 +144,19 @@ std::uint64_t Part2(Input& input) {
 
 }  // namespace
 
-Task<void> Day17(tcp::Socket& socket) {
+Task<void> Day17(Stream& stream, Response& response) {
   Input input;
-  co_await input.Read(socket);
+  co_await input.Read(stream);
+  response.RecordEvent(Event::kInputParsed);
 
   char part1_buffer[128];
   const std::string_view part1 = Part1(input, part1_buffer);
+  response.RecordEvent(Event::kPart1Done);
   const std::uint64_t part2 = Part2(input);
+  response.RecordEvent(Event::kDone);
   std::println("part1: {}\npart2: {}", part1, part2);
 
-  char result[64];
-  const char* end = std::format_to(result, "{}\n{}\n", part1, part2);
-  co_await socket.Write(std::span<const char>(result, end - result));
+  response.Print("{}\n{}\n", part1, part2);
 }
 
 }  // namespace aoc2024
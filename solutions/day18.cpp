@@ -2,9 +2,12 @@
 #include <print>
 
 #include "../common/api.hpp"
+#include "../common/bit_grid.hpp"
+#include "../common/buffered_reader.hpp"
 #include "../common/coro.hpp"
 #include "../common/scan.hpp"
-#include "tcp.hpp"
+#include "../common/stream.hpp"
+#include "../common/union_find.hpp"
 
 namespace aoc2024 {
 namespace {
@@ -24,13 +27,13 @@ bool InBounds(Vec position) {
 }
 
 struct Input {
-  Task<void> Read(tcp::Socket& socket) {
-    char buffer[20000];
-    std::string_view input(co_await socket.Read(buffer));
+  Task<void> Read(Stream& stream) {
+    char buffer[16];
+    BufferedReader reader(stream, buffer);
     std::uint16_t time = 1;
-    while (!input.empty()) {
+    while (std::optional<std::string_view> line = co_await reader.ReadLine()) {
       std::uint8_t x, y;
-      if (!ScanPrefix(input, "{},{}\n", x, y)) {
+      if (!Scan<"{},{}">(*line, x, y) || x > 70 || y > 70) {
         throw std::runtime_error("bad input");
       }
       cells[y][x] = time++;
@@ -47,160 +50,76 @@ struct Input {
   std::uint16_t cells[71][71] = {};
 };
 
-class VisitedSet {
- public:
-  bool Insert(Vec position) {
-    if (Has(position)) return false;
-    data_[position.y][position.x / 32] |= 1 << (position.x % 32);
-    assert(Has(position));
-    return true;
-  }
+using Region = BitGrid<71, 71>;
 
-  bool Has(Vec position) const {
-    assert(InBounds(position));
-    return data_[position.y][position.x / 32] & (1 << (position.x % 32));
+// Every step costs the same, so a breadth-first search finds the shortest path.
+// The search grows the whole reached region by one layer at a time.
+int Part1(const Input& input) {
+  Region open = Region::Full();
+  for (int y = 0; y < 71; y++) {
+    for (int x = 0; x < 71; x++) {
+      if (0 < input[x, y] && input[x, y] <= 1024) open.Reset(x, y);
+    }
   }
-
- private:
-  std::uint32_t data_[71][3] = {};
-};
-
-class Frontier {
- public:
-  struct Node {
-    // Cost to reach this position.
-    std::uint16_t cost;
-    // Actual cost plus heuristic estimate of the cost to reach the goal.
-    std::uint16_t guess;
-    Vec position;
-  };
-
-  bool Empty() const { return size_ == 0; }
-
-  Node Pop() {
-    assert(!Empty());
-    std::ranges::pop_heap(data_, data_ + size_, std::greater<>(), &Node::guess);
-    return data_[--size_];
+  Region reached;
+  reached.Set(0, 0);
+  int steps = 0;
+  while (!reached[kEnd.x, kEnd.y]) {
+    const Region next = reached.Expand(open);
+    if (next == reached) throw std::runtime_error("no solution");
+    reached = next;
+    steps++;
   }
+  return steps;
+}
 
-  void Push(Node node) {
-    assert(size_ < kMaxSize);
-    data_[size_++] = node;
-    std::ranges::push_heap(data_, data_ + size_, std::greater<>(),
-                           &Node::guess);
+// Which edges of the grid a wall touches.
+struct Edges {
+  void Merge(const Edges& other) {
+    top_right |= other.top_right;
+    bottom_left |= other.bottom_left;
   }
 
- private:
-  static constexpr int kMaxSize = 10000;
-  Node data_[kMaxSize];
-  int size_ = 0;
+  // True if this wall is transitively connected to the top right edge.
+  bool top_right : 1;
+  // True if this wall is transitively connected to the bottom left edge.
+  bool bottom_left : 1;
 };
 
-std::uint16_t GuessCost(Vec position) {
-  return std::abs(kEnd.x - position.x) + std::abs(kEnd.y - position.y);
-}
-
-int Part1(const Input& input) {
-  VisitedSet visited;
-  Frontier frontier;
-  frontier.Push({
-      .cost = 0,
-      .guess = GuessCost(Vec(0, 0)),
-      .position = Vec(0, 0),
-  });
-  while (!frontier.Empty()) {
-    const Frontier::Node node = frontier.Pop();
-    if (!visited.Insert(node.position)) continue;
-    if (node.position == kEnd) return node.cost;
-    for (Vec offset : {Vec(-1, 0), Vec(1, 0), Vec(0, -1), Vec(0, 1)}) {
-      const Vec neighbour = node.position + offset;
-      if (!InBounds(neighbour)) continue;
-      if (0 < input[neighbour] && input[neighbour] <= 1024) continue;
-      frontier.Push({
-          .cost = std::uint16_t(node.cost + 1),
-          .guess = std::uint16_t(node.cost + GuessCost(neighbour)),
-          .position = neighbour,
-      });
-    }
-  }
-  throw std::runtime_error("no solution");
-}
-
 class Walls {
  public:
-  struct Node {
-    Vec parent;
-    std::uint16_t size : 13;
-    // True if this node is transitively connected to the top right edge.
-    std::uint16_t top_right : 1;
-    // True if this node is transitively connected to the bottom left edge.
-    std::uint16_t bottom_left: 1;
-    // False if this node has not been added (and should thus be ignored).
-    std::uint16_t seen : 1;
-  };
-
   Walls() {
-    for (int y = 0; y < 71; y++) {
-      for (int x = 0; x < 71; x++) {
-        nodes_[y][x].parent = Vec(x, y);
-      }
-    }
+    walls_.Reset(71 * 71);
     for (int i = 0; i < 71; i++) {
-      nodes_[i][0].bottom_left = true;
-      nodes_[0][i].top_right = true;
-      nodes_[i][70].top_right = true;
-      nodes_[70][i].bottom_left = true;
+      walls_.payload(Index(0, i)).bottom_left = true;
+      walls_.payload(Index(i, 0)).top_right = true;
+      walls_.payload(Index(70, i)).top_right = true;
+      walls_.payload(Index(i, 70)).bottom_left = true;
     }
   }
 
-  Node& Add(Vec position) {
-    assert(!Get(position).seen);
-    Get(position).seen = 1;
+  // Adds a byte to the walls and returns the edges which its wall touches.
+  const Edges& Add(Vec position) {
+    assert((!seen_[position.x, position.y]));
+    seen_.Set(position.x, position.y);
     static constexpr Vec kOffsets[] = {Vec(-1, -1), Vec(0, -1), Vec(1, -1),
                                        Vec(-1, 0),              Vec(1, 0),
                                        Vec(-1, 1), Vec(0, 1),   Vec(1, 1)};
     for (Vec offset : kOffsets) {
       const Vec neighbour = position + offset;
-      if (!InBounds(neighbour) || !Get(neighbour).seen) continue;
-      Merge(position, neighbour);
+      if (!InBounds(neighbour) || !seen_[neighbour.x, neighbour.y]) continue;
+      walls_.Merge(Index(position), Index(neighbour));
     }
-
-    return Get(Find(position));
+    return walls_.payload(walls_.Find(Index(position)));
   }
 
  private:
-  Node& Get(Vec position) {
-    assert(InBounds(position));
-    return nodes_[position.y][position.x];
-  }
-
-  Vec Root(Vec node) {
-    Vec i = node;
-    while (i != Get(i).parent) i = Get(i).parent;
-    return i;
-  }
-
-  Vec Find(Vec node) {
-    const Vec root = Root(node);
-    Vec i = node;
-    while (i != root) i = std::exchange(Get(i).parent, root);
-    return i;
-  }
-
-  void Merge(Vec a, Vec b) {
-    a = Find(a);
-    b = Find(b);
-    if (a == b) return;
-    if (Get(a).size < Get(b).size) std::swap(a, b);
-    Node& parent = Get(a);
-    Node& child = Get(b);
-    parent.size += child.size;
-    parent.top_right |= child.top_right;
-    parent.bottom_left |= child.bottom_left;
-    child.parent = a;
-  }
+  static std::int16_t Index(int x, int y) { return y * 71 + x; }
+  static std::int16_t Index(Vec v) { return Index(v.x, v.y); }
 
-  Node nodes_[71][71] = {};
+  // Bytes which have been added.
+  Region seen_;
+  UnionFind<std::int16_t, Edges, 71 * 71> walls_;
 };
 
 // The approach I'm using here is to search for an unbroken wall that connects
@@ -223,7 +142,7 @@ Vec Part2(const Input& input) {
                     [&](Vec v) { return input[v]; });
   Walls walls;
   for (Vec byte : std::span(bytes, num_bytes)) {
-    Walls::Node& wall = walls.Add(byte);
+    const Edges& wall = walls.Add(byte);
     if (wall.top_right && wall.bottom_left) return byte;
   }
   throw std::runtime_error("no byte obstructs the path");
@@ -231,18 +150,18 @@ Vec Part2(const Input& input) {
 
 }  // namespace
 
-Task<void> Day18(tcp::Socket& socket) {
+Task<void> Day18(Stream& stream, Response& response) {
   Input input;
-  co_await input.Read(socket);
+  co_await input.Read(stream);
+  response.RecordEvent(Event::kInputParsed);
 
   const int part1 = Part1(input);
+  response.RecordEvent(Event::kPart1Done);
   const Vec part2 = Part2(input);
+  response.RecordEvent(Event::kDone);
   std::println("part1: {}\npart2: {},{}", part1, part2.x, part2.y);
 
-  char result[64];
-  const char* end =
-      std::format_to(result, "{}\n{},{}\n", part1, part2.x, part2.y);
-  co_await socket.Write(std::span<const char>(result, end - result));
+  response.Print("{}\n{},{}\n", part1, part2.x, part2.y);
 }
 
 }  // namespace aoc2024
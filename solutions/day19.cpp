@@ -5,7 +5,7 @@
 #include "../common/api.hpp"
 #include "../common/coro.hpp"
 #include "../common/scan.hpp"
-#include "tcp.hpp"
+#include "../common/stream.hpp"
 
 namespace aoc2024 {
 namespace {
@@ -67,8 +67,8 @@ class TowelTrie {
 };
 
 struct Input {
-  Task<void> Read(tcp::Socket& socket) {
-    std::string_view input(co_await socket.Read(buffer));
+  Task<void> Read(Stream& stream) {
+    std::string_view input(co_await stream.Read(buffer));
     Word towel;
     if (!ScanPrefix(input, "{}", towel)) throw std::runtime_error("syntax");
     towels.Add(towel.value);
@@ -107,9 +107,10 @@ std::uint64_t Arrangements(std::string_view pattern, const TowelTrie& towels) {
 
 }  // namespace
 
-Task<void> Day19(tcp::Socket& socket) {
+Task<void> Day19(Stream& stream, Response& response) {
   Input input;
-  co_await input.Read(socket);
+  co_await input.Read(stream);
+  response.RecordEvent(Event::kInputParsed);
 
   int part1 = 0;
   std::uint64_t part2 = 0;
@@ -118,12 +119,10 @@ Task<void> Day19(tcp::Socket& socket) {
     if (arrangements > 0) part1++;
     part2 += arrangements;
   }
+  response.RecordEvent(Event::kDone);
   std::println("part1: {}\npart2: {}", part1, part2);
 
-  char result[32];
-  const char* end =
-      std::format_to(result, "{}\n{}\n", part1, part2);
-  co_await socket.Write(std::span<const char>(result, end - result));
+  response.Print("{}\n{}\n", part1, part2);
 }
 
 }  // namespace aoc2024
@@ -1,9 +1,12 @@
+#include "../common/api.hpp"
 #include "../common/coro.hpp"
+#include "../common/grid.hpp"
+#include "../common/parallel.hpp"
 #include "../common/scan.hpp"
-#include "tcp.hpp"
+#include "../common/stream.hpp"
+#include "../common/yield.hpp"
 
 #include <algorithm>
-#include <generator>
 #include <print>
 #include <ranges>
 
@@ -34,67 +37,53 @@ struct Input {
   Input(const Input&) = delete;
   Input& operator=(const Input&) = delete;
 
-  auto& operator[](this auto&& self, int x, int y) {
-    assert(self.InBounds(Vec(x, y)));
-    return self.grid[y][x];
-  }
-
-  auto& operator[](this auto&& self, Vec v) { return self[v.x, v.y]; }
-
-  bool InBounds(Vec v) const {
-    return 0 <= v.x && v.x < width && 0 <= v.y && v.y < height;
-  }
-
-  Task<void> Read(tcp::Socket& socket) {
+  Task<void> Read(Stream& stream) {
     char input_buffer[20030];
-    const std::string_view input(co_await socket.Read(input_buffer));
-    if (input.empty() || input.back() != '\n') {
-      throw std::runtime_error("bad input (truncated)");
+    const Grid<const char> text =
+        ParseGrid(std::string_view(co_await stream.Read(input_buffer)));
+    width = text.width();
+    height = text.height();
+    if (width > kMaxSize || height > kMaxSize) {
+      throw std::runtime_error("grid too big");
     }
-
-    // This must succeed: the input ends with '\n'.
-    width = std::string_view(input).find('\n');
-    if (input.size() % (width + 1) != 0) {
-      throw std::runtime_error("grid is not rectangular");
-    }
-    height = input.size() / (width + 1);
     std::println("grid size: {}x{}", width, height);
 
-    const auto start_index = input.find('S');
-    if (start_index == input.npos) throw std::runtime_error("no start");
-    start = Vec(start_index % (width + 1), start_index / (width + 1));
+    const std::optional<int> start_index = text.Find('S');
+    if (!start_index) throw std::runtime_error("no start");
+    start = text.Position<Vec>(*start_index);
 
-    const auto end_index = input.find('E');
-    if (end_index == input.npos) throw std::runtime_error("no end");
-    end = Vec(end_index % (width + 1), end_index / (width + 1));
+    const std::optional<int> end_index = text.Find('E');
+    if (!end_index) throw std::runtime_error("no end");
+    end = text.Position<Vec>(*end_index);
 
-    // Populate the walls.
-    for (int y = 0; y < height; y++) {
-      for (int x = 0; x < width; x++) {
-        grid[y][x] = Cell{.wall = input[y * (width + 1) + x] == '#', .time = 0};
-      }
-    }
+    // Populate the walls. The border is wide enough that a cheat of length 2
+    // from any cell stays within it.
+    grid = Grid<Cell>::WithBorder(cells, width, height,
+                                  Cell{.wall = 1, .time = 0}, 2);
+    grid.Assign(text, [](char c) { return Cell{.wall = c == '#', .time = 0}; });
     // Populate the times.
     Vec position = start;
     std::uint16_t time = 1;
-    (*this)[start].time = time;
+    grid[start].time = time;
     while (position != end) {
       bool found = false;
       for (Vec offset : kOffsets) {
         const Vec neighbour = position + offset;
-        if (!(*this)[neighbour].wall && (*this)[neighbour].time == 0) {
+        if (!grid[neighbour].wall && grid[neighbour].time == 0) {
           found = true;
           position = neighbour;
           break;
         }
       }
       if (!found) throw std::runtime_error("dead end");
-      (*this)[position].time = ++time;
+      grid[position].time = ++time;
     }
     std::println("default path takes time={}", time);
   }
 
-  Cell grid[141][141];
+  static constexpr int kMaxSize = 141;
+  Cell cells[Grid<Cell>::BufferSize(kMaxSize, kMaxSize, 2)];
+  Grid<Cell> grid;
   int width, height;
   Vec start, end;
 };
@@ -106,13 +95,12 @@ int Part1(const Input& input) {
   for (int y = 1; y < y_max; y++) {
     for (int x = 1; x < x_max; x++) {
       const Vec position = Vec(x, y);
-      if (input[position].wall) continue;
+      if (input.grid[position].wall) continue;
       for (Vec offset : kOffsets) {
-        if (!input.InBounds(position + 2 * offset)) continue;
-        if (!input[position + offset].wall) continue;
-        if (input[position + 2 * offset].wall) continue;
-        const int time_saved =
-            input[position + 2 * offset].time - input[position].time - 2;
+        if (!input.grid[position + offset].wall) continue;
+        if (input.grid[position + 2 * offset].wall) continue;
+        const int time_saved = input.grid[position + 2 * offset].time -
+                               input.grid[position].time - 2;
         if (time_saved >= 100) count++;
       }
     }
@@ -120,53 +108,63 @@ int Part1(const Input& input) {
   return count;
 }
 
-std::generator<Vec> Cheats(int range) {
-  // Points within a given range of a position form a diamond around that
-  // position.
-  for (int y = -range; y <= range; y++) {
-    const int delta = range - std::abs(y);
-    for (int x = -delta; x <= delta; x++) {
-      if (x == 0 && y == 0) continue;
-      co_yield Vec(x, y);
-    }
-  }
-}
-
-int Part2(const Input& input) {
-  int count = 0;
+Task<int> Part2(const Input& input) {
   const int x_max = input.width - 1;
   const int y_max = input.height - 1;
-  for (int y = 1; y < y_max; y++) {
+  auto count_row = [&](int y) {
+    int count = 0;
     for (int x = 1; x < x_max; x++) {
       const Vec position = Vec(x, y);
-      if (input[position].wall) continue;
-      for (Vec offset : Cheats(20)) {
-        const Vec destination = position + offset;
-        if (!input.InBounds(destination)) continue;
-        if (input[destination].wall) continue;
-        const int cheat_duration = offset.ManhattanLength();
-        const int time_saved =
-            input[destination].time - input[position].time - cheat_duration;
-        if (time_saved >= 100) count++;
+      if (input.grid[position].wall) continue;
+      // Points within a given range of a position form a diamond around that
+      // position. The diamond is clipped to the grid up front rather than
+      // checking each point.
+      constexpr int kRange = 20;
+      const int dy_min = std::max(-kRange, -y);
+      const int dy_max = std::min(kRange, input.height - 1 - y);
+      for (int dy = dy_min; dy <= dy_max; dy++) {
+        const int delta = kRange - std::abs(dy);
+        const int dx_min = std::max(-delta, -x);
+        const int dx_max = std::min(delta, input.width - 1 - x);
+        for (int dx = dx_min; dx <= dx_max; dx++) {
+          const Vec offset = Vec(dx, dy);
+          const Vec destination = position + offset;
+          if (input.grid[destination].wall) continue;
+          const int cheat_duration = offset.ManhattanLength();
+          const int time_saved = input.grid[destination].time -
+                                 input.grid[position].time - cheat_duration;
+          if (time_saved >= 100) count++;
+        }
       }
     }
+    return count;
+  };
+  // The rows are counted in bands, which gives the event loop a chance to run
+  // in between.
+  constexpr int kBandHeight = 8;
+  int count = 0;
+  for (int y = 1; y < y_max; y += kBandHeight) {
+    co_await MaybeYield();
+    count += co_await ParallelSum<int>(y, std::min(y + kBandHeight, y_max),
+                                       count_row);
   }
-  return count;
+  co_return count;
 }
 
 }  // namespace
 
-Task<void> Day20(tcp::Socket& socket) {
+Task<void> Day20(Stream& stream, Response& response) {
   Input input;
-  co_await input.Read(socket);
+  co_await input.Read(stream);
+  response.RecordEvent(Event::kInputParsed);
 
   const int part1 = Part1(input);
-  const int part2 = Part2(input);
+  response.RecordEvent(Event::kPart1Done);
+  const int part2 = co_await Part2(input);
+  response.RecordEvent(Event::kDone);
   std::println("part1: {}\npart2: {}\n", part1, part2);
 
-  char result[32];
-  const char* end = std::format_to(result, "{}\n{}\n", part1, part2);
-  co_await socket.Write(std::span<const char>(result, end - result));
+  response.Print("{}\n{}\n", part1, part2);
 }
 
 }  // namespace aoc2024
@@ -1,6 +1,8 @@
+#include "../common/api.hpp"
 #include "../common/coro.hpp"
+#include "../common/frontier.hpp"
 #include "../common/scan.hpp"
-#include "tcp.hpp"
+#include "../common/stream.hpp"
 
 #include <algorithm>
 #include <print>
@@ -15,8 +17,8 @@ struct Input {
     int number;
   };
 
-  Task<void> Read(tcp::Socket& socket) {
-    std::string_view input(co_await socket.Read(buffer));
+  Task<void> Read(Stream& stream) {
+    std::string_view input(co_await stream.Read(buffer));
     if (input.size() != 25) throw std::runtime_error("bad input");
     for (int code = 0; code < 5; code++) {
       int number = 0;
@@ -78,40 +80,21 @@ constexpr Grid kArrows = {
                 {'<',  'v', '>'}},
 };
 
-class Frontier {
- public:
-  struct Node {
-    // Position of the robot hand in this layer.
-    Vec position;
-    // Number of digits pressed on the keypad controlled by this robot.
-    std::uint16_t digits_produced;
-    // Last instruction given to this robot (initially 'A').
-    char previous;
-    // Total cost (buttons pressed by hand) of instructions given to this robot.
-    std::uint64_t cost;
-  };
-
-  bool Empty() const { return size_ == 0; }
-
-  Node Pop() {
-    assert(!Empty());
-    std::ranges::pop_heap(data_, data_ + size_, std::greater<>(), &Node::cost);
-    return data_[--size_];
-  }
-
-  void Push(Node node) {
-    assert(size_ < kMaxSize);
-    data_[size_++] = node;
-    std::ranges::push_heap(data_, data_ + size_, std::greater<>(),
-                           &Node::cost);
-  }
-
- private:
-  static constexpr int kMaxSize = 750;
-  Node data_[kMaxSize];
-  int size_ = 0;
+struct Node {
+  // Position of the robot hand in this layer.
+  Vec position;
+  // Number of digits pressed on the keypad controlled by this robot.
+  std::uint16_t digits_produced;
+  // Last instruction given to this robot (initially 'A').
+  char previous;
+  // Total cost (buttons pressed by hand) of instructions given to this robot.
+  std::uint64_t cost;
 };
 
+// Costs grow exponentially with the number of robots, so they are too sparse
+// for buckets.
+using Frontier = BinaryHeapFrontier<Node, &Node::cost, 750>;
+
 int ActionIndex(char c) {
   static constexpr char kActions[] = "A<>v^";
   for (int i = 0; i < 5; i++) {
@@ -123,7 +106,7 @@ int ActionIndex(char c) {
 template <Grid kGrid>
 class VisitedSet {
  public:
-  bool Insert(const Frontier::Node& node) {
+  bool Insert(const Node& node) {
     assert(kGrid.InBounds(node.position));
     const int i = node.position.y * 3 + node.position.x;
     std::uint16_t& bitmap =
@@ -171,9 +154,8 @@ class Costs {
 };
 
 template <Grid kGrid>
-std::optional<Frontier::Node> TryAction(std::string_view target,
-                                        Frontier::Node node, char c,
-                                        const Costs& costs) {
+std::optional<Node> TryAction(std::string_view target, Node node, char c,
+                              const Costs& costs) {
   node.cost += costs[node.previous, c];
   node.previous = c;
   if (c != 'A') {
@@ -200,11 +182,11 @@ std::uint64_t NumPresses(char initial, std::string_view target,
       .cost = 0,
   });
   while (!frontier.Empty()) {
-    const Frontier::Node node = frontier.Pop();
+    const Node node = frontier.Pop();
     if (!visited.Insert(node)) continue;
     if (node.digits_produced == target.size()) return node.cost;
     for (char action : {'A', '<', '>', '^', 'v'}) {
-      const std::optional<Frontier::Node> next =
+      const std::optional<Node> next =
           TryAction<kGrid>(target, node, action, costs);
       if (next) frontier.Push(*next);
     }
@@ -238,16 +220,17 @@ std::uint64_t Solve(const Input& input) {
 
 }  // namespace
 
-Task<void> Day21(tcp::Socket& socket) {
+Task<void> Day21(Stream& stream, Response& response) {
   Input input;
-  co_await input.Read(socket);
+  co_await input.Read(stream);
+  response.RecordEvent(Event::kInputParsed);
 
   const std::uint64_t part1 = Solve<2>(input);
+  response.RecordEvent(Event::kPart1Done);
   const std::uint64_t part2 = Solve<25>(input);
+  response.RecordEvent(Event::kDone);
 
-  char result[32];
-  const char* end = std::format_to(result, "{}\n{}\n", part1, part2);
-  co_await socket.Write(std::span<const char>(result, end - result));
+  response.Print("{}\n{}\n", part1, part2);
 }
 
 }  // namespace aoc2024
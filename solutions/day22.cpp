@@ -1,24 +1,22 @@
+#include "../common/api.hpp"
 #include "../common/coro.hpp"
-#include "../common/scan.hpp"
-#include "tcp.hpp"
+#include "../common/integers.hpp"
+#include "../common/parallel.hpp"
+#include "../common/stream.hpp"
+#include "../common/yield.hpp"
 
 #include <algorithm>
+#include <memory_resource>
 #include <print>
+#include <span>
+#include <vector>
 
 namespace aoc2024 {
 namespace {
 
 struct Input {
-  Task<void> Read(tcp::Socket& socket) {
-    char input_buffer[18000];
-    std::string_view input(co_await socket.Read(input_buffer));
-
-    int num_values = 0;
-    for (int x; ScanPrefix(input, "{}\n", x);) {
-      if (num_values == kMaxValues) throw std::runtime_error("too many lines");
-      buffer[num_values++] = x;
-    }
-    values = std::span(buffer, num_values);
+  Task<void> Read(Stream& stream) {
+    values = co_await ReadIntegers(stream, std::span(buffer));
   }
 
   static constexpr int kMaxValues = 2100;
@@ -36,17 +34,56 @@ std::uint32_t Step(std::uint32_t secret) {
   return secret;
 }
 
-std::uint64_t Part1(const Input& input) {
+Task<std::uint64_t> Part1(const Input& input) {
+  auto simulate = [&](int i) -> std::uint64_t {
+    std::uint32_t secret = input.values[i];
+    for (int j = 0; j < 2000; j++) secret = Step(secret);
+    return secret;
+  };
+  // The monkeys are simulated in slices, yielding to the event loop in between.
+  constexpr int kSliceSize = 256;
+  const int n = input.values.size();
   std::uint64_t total = 0;
-  for (int value : input.values) {
-    std::uint32_t secret = value;
-    for (int i = 0; i < 2000; i++) secret = Step(secret);
-    total += secret;
+  for (int begin = 0; begin < n; begin += kSliceSize) {
+    co_await MaybeYield();
+    total += co_await ParallelSum<std::uint64_t>(
+        begin, std::min(begin + kSliceSize, n), simulate);
+  }
+  co_return total;
+}
+
+// Simulates the monkey whose first secret is `secret`, adding the price at
+// the first occurrence of each sequence of price changes to its count. Only
+// sequences in the batch starting at `batch_start` (and as big as `counts`)
+// are counted, and `seen` must be clear for all of them.
+//
+// This is kept out of `Part2` so that the hot loop isn't affected by the
+// coroutine frame.
+void AddPrices(std::uint32_t secret, int batch_start,
+               std::span<std::uint16_t> counts, std::pmr::vector<bool>& seen) {
+  const int batch_end = batch_start + counts.size();
+  std::uint8_t digits[5] = {};
+  digits[0] = secret % 10;
+  for (int i = 1; i <= 2000; i++) {
+    secret = Step(secret);
+    digits[i % 5] = secret % 10;
+    if (i < 4) continue;  // Wait until we have 5 values (4 price changes).
+    const std::uint8_t min = *std::ranges::min_element(digits);
+    int index = 0;
+    for (int j = 1; j <= 5; j++) {
+      const std::uint8_t digit = digits[(i + j) % 5] - min;
+      index = 10 * index + digit;
+    }
+    if (batch_start <= index && index < batch_end) {
+      index -= batch_start;
+      if (seen[index]) continue;
+      seen[index] = true;
+      counts[index] += digits[i % 5];
+    }
   }
-  return total;
 }
 
-int Part2(const Input& input) {
+Task<int> Part2(const Input& input, std::pmr::memory_resource& memory) {
   // The overall approach here is to simulate each sequence of 2000 values and
   // keep track of the first time we see each sequence of 4 price changes for
   // each monkey sequence, and the corresponding price we get for it. Logically,
@@ -67,53 +104,39 @@ int Part2(const Input& input) {
   constexpr int kDomainSize = 100000;
   constexpr int kBatchSize = kDomainSize / 2;
   static_assert(kDomainSize % kBatchSize == 0);
+  // The arrays are allocated once and cleared for each batch (and monkey).
+  std::pmr::vector<std::uint16_t> counts(&memory);
+  std::pmr::vector<bool> seen(&memory);
   int best = 0;
   for (int batch_start = 0; batch_start < kDomainSize;
        batch_start += kBatchSize) {
-    std::vector<std::uint16_t> counts(kBatchSize);
-    const int batch_end = batch_start + kBatchSize;
+    counts.assign(kBatchSize, 0);
     for (int value : input.values) {
-      std::vector<bool> seen(kBatchSize);
-      std::uint32_t secret = value;
-      std::uint8_t digits[5] = {};
-      digits[0] = secret % 10;
-      for (int i = 1; i <= 2000; i++) {
-        secret = Step(secret);
-        digits[i % 5] = secret % 10;
-        if (i < 4) continue;  // Wait until we have 5 values (4 price changes).
-        const std::uint8_t min = *std::ranges::min_element(digits);
-        int index = 0;
-        for (int j = 1; j <= 5; j++) {
-          const std::uint8_t digit = digits[(i + j) % 5] - min;
-          index = 10 * index + digit;
-        }
-        if (batch_start <= index && index < batch_end) {
-          index -= batch_start;
-          if (seen[index]) continue;
-          seen[index] = true;
-          counts[index] += digits[i % 5];
-        }
-      }
+      // The batches take far too long to run without a break.
+      co_await MaybeYield();
+      seen.assign(kBatchSize, false);
+      AddPrices(value, batch_start, counts, seen);
     }
     const int batch_best = *std::ranges::max_element(counts);
     best = std::max(best, batch_best);
   }
-  return best;
+  co_return best;
 }
 
 }  // namespace
 
-Task<void> Day22(tcp::Socket& socket) {
+Task<void> Day22(Stream& stream, Response& response) {
   Input input;
-  co_await input.Read(socket);
+  co_await input.Read(stream);
+  response.RecordEvent(Event::kInputParsed);
 
-  const std::uint64_t part1 = Part1(input);
-  const int part2 = Part2(input);
+  const std::uint64_t part1 = co_await Part1(input);
+  response.RecordEvent(Event::kPart1Done);
+  const int part2 = co_await Part2(input, response.memory());
+  response.RecordEvent(Event::kDone);
   std::println("part1: {}\npart2: {}\n", part1, part2);
 
-  char result[32];
-  const char* end = std::format_to(result, "{}\n{}\n", part1, part2);
-  co_await socket.Write(std::span<const char>(result, end - result));
+  response.Print("{}\n{}\n", part1, part2);
 }
 
 }  // namespace aoc2024
@@ -1,12 +1,16 @@
+#include "../common/api.hpp"
 #include "../common/coro.hpp"
+#include "../common/record_scanner.hpp"
 #include "../common/scan.hpp"
-#include "tcp.hpp"
+#include "../common/stream.hpp"
 
 #include <algorithm>
 #include <bitset>
 #include <generator>
 #include <map>
+#include <memory_resource>
 #include <print>
+#include <vector>
 
 namespace aoc2024 {
 namespace {
@@ -25,29 +29,44 @@ bool ScanValue(std::string_view& input, Computer& c) {
 }
 
 struct Input {
+  // Nodes are allocated from the same memory as the `nodes` vector.
   struct Node {
-    int id;
-    std::vector<std::uint16_t> neighbors;
+    using allocator_type = std::pmr::polymorphic_allocator<>;
+
+    explicit Node(const allocator_type& allocator) : neighbors(allocator) {}
+    Node(Node&& other, const allocator_type& allocator)
+        : id(other.id), neighbors(std::move(other.neighbors), allocator) {}
+
+    int id = 0;
+    std::pmr::vector<std::uint16_t> neighbors;
   };
 
-  Task<void> Read(tcp::Socket& socket) {
-    char buffer[21000];
-    std::string_view input(co_await socket.Read(buffer));
+  explicit Input(std::pmr::memory_resource& memory) : nodes(&memory) {
+    // There is at most one node for each two letter name.
+    nodes.reserve(26 * 26);
+  }
+
+  Task<void> Read(Stream& stream) {
+    RecordScanner scanner(stream);
 
     int next_index = 0;
-    std::map<int, int> indices;
+    std::pmr::map<int, int> indices(nodes.get_allocator());
     const auto get_index = [&](int id) {
       auto [i, is_new] = indices.try_emplace(id, next_index);
       if (is_new) {
         Node& node = nodes.emplace_back();
         node.id = id;
+        // Memory isn't reused within a request, so growing the vector is
+        // wasteful. Computers in the puzzle each have 13 connections.
+        node.neighbors.reserve(16);
         next_index++;
       }
       return i->second;
     };
 
     Computer a, b;
-    while (ScanPrefix(input, "{}-{}\n", a, b)) {
+    while (co_await scanner.Fill() &&
+           ScanPrefix<"{}-{}\n">(scanner.input(), a, b)) {
       const int i = get_index(a.id), j = get_index(b.id);
       nodes[i].neighbors.push_back(j);
       nodes[j].neighbors.push_back(i);
@@ -58,7 +77,7 @@ struct Input {
     }
   }
 
-  std::vector<Node> nodes;
+  std::pmr::vector<Node> nodes;
 };
 
 bool HasT(int id) { return id / 26 == 't' - 'a'; }
@@ -129,16 +148,17 @@ std::string Part2(const Input& input) {
 
 }  // namespace
 
-Task<void> Day23(tcp::Socket& socket) {
-  Input input;
-  co_await input.Read(socket);
+Task<void> Day23(Stream& stream, Response& response) {
+  Input input(response.memory());
+  co_await input.Read(stream);
+  response.RecordEvent(Event::kInputParsed);
 
   const int part1 = Part1(input);
+  response.RecordEvent(Event::kPart1Done);
   const std::string part2 = Part2(input);
+  response.RecordEvent(Event::kDone);
 
-  char result[256];
-  const char* end = std::format_to(result, "{}\n{}\n", part1, part2);
-  co_await socket.Write(std::span<const char>(result, end - result));
+  response.Print("{}\n{}\n", part1, part2);
 }
 
 }  // namespace aoc2024
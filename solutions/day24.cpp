@@ -1,10 +1,12 @@
+#include "../common/api.hpp"
 #include "../common/coro.hpp"
 #include "../common/scan.hpp"
-#include "tcp.hpp"
+#include "../common/stream.hpp"
 
 #include <algorithm>
 #include <cstring>
 #include <map>
+#include <memory_resource>
 #include <print>
 
 namespace aoc2024 {
@@ -76,9 +78,9 @@ bool ScanValue(std::string_view& input, Gate::Type& type) {
 }
 
 struct Input {
-  Task<void> Read(tcp::Socket& socket) {
+  Task<void> Read(Stream& stream) {
     char buffer[5000];
-    std::string_view input(co_await socket.Read(buffer));
+    std::string_view input(co_await stream.Read(buffer));
 
     {
       Id id;
@@ -114,8 +116,8 @@ struct Input {
   Gate gates[kMaxGates];
 };
 
-std::uint64_t Part1(const Input& input) {
-  std::map<Id, bool> values;
+std::uint64_t Part1(const Input& input, std::pmr::memory_resource& memory) {
+  std::pmr::map<Id, bool> values(&memory);
   for (int i = 0; i < input.num_gates; i++) {
     if (input.gates[i].type == Gate::kConst) {
       values[input.gates[i].id] = input.gates[i].value;
@@ -164,17 +166,18 @@ int Part2(const Input&) {
 
 }  // namespace
 
-Task<void> Day24(tcp::Socket& socket) {
+Task<void> Day24(Stream& stream, Response& response) {
   std::println("parsing input...");
   Input input;
-  co_await input.Read(socket);
+  co_await input.Read(stream);
+  response.RecordEvent(Event::kInputParsed);
 
-  const std::uint64_t part1 = Part1(input);
+  const std::uint64_t part1 = Part1(input, response.memory());
+  response.RecordEvent(Event::kPart1Done);
   const int part2 = Part2(input);
+  response.RecordEvent(Event::kDone);
 
-  char result[32];
-  const char* end = std::format_to(result, "{}\n{}\n", part1, part2);
-  co_await socket.Write(std::span<const char>(result, end - result));
+  response.Print("{}\n{}\n", part1, part2);
 }
 
 }  // namespace aoc2024